@@ -0,0 +1,76 @@
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+#include <EventData.h>
+#include <EventTypes.h>
+#include <EventBusLayout.h>
+
+///\brief Publishes selected events into a shared memory ring that any number of local processes can map and read without asking Buckey, see EventBusReader.
+///
+///		Only event types with an EventTypeID below 64 can be published, which covers every built in event type.
+///		Buckey never waits for readers. A reader that falls a whole ring behind finds out through the slot sequence numbers and skips ahead.
+class EventBus
+{
+	public:
+		///Returns the singleton EventBus
+		static EventBus * getInstance();
+
+		///Returns true if triggers of the event type should be handed to publish(), checked by EventSource on every trigger
+		static bool isPublished(EventTypeID type) {
+			return type < 64 && ((publishedTypes.load(std::memory_order_relaxed) >> type) & 1) != 0;
+		}
+
+		///\brief Creates (or takes over) the shared memory object of the given name and starts publishing into it
+		///
+		///		A bus left behind by a Buckey that did not close it is reset in place and its epoch bumped, so readers still following it start over instead of waiting for messages that never come.
+		///\return false if it could not be created or mapped
+		bool open(const std::string & name = EVENT_BUS_NAME);
+
+		///Stops publishing and removes the shared memory object
+		void close();
+
+		///\brief Publishes triggers of the event type once the bus is open
+		///\return false if the ID is too high to be published
+		bool publish(EventTypeID type);
+
+		///Stops publishing triggers of the event type
+		void unpublish(EventTypeID type);
+
+		///Writes the event into the next slot, called by EventSource::triggerEvents()
+		void write(EventTypeID type, const EventData * data);
+
+		///Returns the number of events published since the bus was opened
+		uint64_t getPublished();
+
+	protected:
+		EventBus();
+
+		static EventBus * instance;
+		static std::atomic<bool> instanceSet;
+		///Locked while creating the instance
+		static std::mutex instanceLock;
+
+		///Bit n is set if EventTypeID n is published
+		static std::atomic<uint64_t> publishedTypes;
+
+		///Event types set with publish(), copied to publishedTypes while the bus is open
+		std::atomic<uint64_t> selectedTypes;
+
+		///Locked by writers, so triggers from several threads take turns at the ring
+		std::mutex writeLock;
+
+		///Name the shared memory object was opened with, empty when closed
+		std::string name;
+		EventBusHeader * header;
+		EventBusSlot * slots;
+		///Reused to serialize the EventData of each write
+		std::string buffer;
+		///Names of the published event types, indexed by EventTypeID
+		std::string typeNames[64];
+};
+
+#endif // EVENTBUS_H
@@ -0,0 +1,58 @@
+#ifndef EVENTBUSLAYOUT_H
+#define EVENTBUSLAYOUT_H
+#include <atomic>
+#include <cstdint>
+
+///Default name of the shared memory object, see shm_open()
+#define EVENT_BUS_NAME "/buckey-events"
+///Written last when Buckey sets up the bus, readers wait for it
+#define EVENT_BUS_MAGIC 0x4255434BU
+///Bumped whenever the layout below changes
+#define EVENT_BUS_VERSION 2
+///Number of slots in the ring, must be a power of two
+#define EVENT_BUS_SLOTS 1024
+///Longest event type name a slot holds, including the terminating 0
+#define EVENT_BUS_TYPE_SIZE 40
+///Bytes of serialized EventData a slot holds, longer payloads are cut and marked truncated
+#define EVENT_BUS_PAYLOAD_SIZE 448
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "The event bus needs lock free 64 bit atomics to share them between processes");
+
+///\brief One published event in the shared memory ring.
+///
+///		The slot of message number n is n % EVENT_BUS_SLOTS. sequence is a seqlock: Buckey sets it to 2n + 1 before writing message n into the slot and to 2n + 2 once it is done.
+///		A reader copies the slot out between two reads of sequence and only keeps the copy if both reads were 2n + 2, anything higher means Buckey has lapped it.
+struct EventBusSlot {
+	std::atomic<uint64_t> sequence;
+	///Microseconds since the epoch when the event was triggered
+	uint64_t micros;
+	///Bytes of payload used
+	uint32_t length;
+	///1 if the serialized EventData did not fit in payload
+	uint32_t truncated;
+	///Name of the event type, 0 terminated
+	char type[EVENT_BUS_TYPE_SIZE];
+	///The EventData as written by EventData::serialize(), read it with a PayloadReader
+	char payload[EVENT_BUS_PAYLOAD_SIZE];
+};
+
+///\brief The start of the shared memory object, followed by EVENT_BUS_SLOTS EventBusSlots
+struct EventBusHeader {
+	///EVENT_BUS_MAGIC once the bus is ready
+	std::atomic<uint32_t> magic;
+	uint32_t version;
+	uint32_t slotCount;
+	uint32_t slotSize;
+	///Number of messages published so far, the newest one is head - 1
+	std::atomic<uint64_t> head;
+	///Process ID of the Buckey that publishes
+	int64_t writerPid;
+	///Bumped every time a Buckey takes the bus over and starts again at message 0, readers that see it change start over too
+	std::atomic<uint64_t> epoch;
+	char padding[24];
+};
+
+///Size of the whole shared memory object
+#define EVENT_BUS_SIZE (sizeof(EventBusHeader) + EVENT_BUS_SLOTS * sizeof(EventBusSlot))
+
+#endif // EVENTBUSLAYOUT_H
@@ -0,0 +1,61 @@
+#ifndef EVENTBUSREADER_H
+#define EVENTBUSREADER_H
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include <EventBusLayout.h>
+
+///\brief One event read from the EventBus
+struct EventBusMessage {
+	///Number of the message, one higher than the message before it unless messages were missed. Starts over at 0 when another Buckey takes the bus over.
+	uint64_t sequence;
+	///Microseconds since the epoch when the event was triggered
+	uint64_t micros;
+	///Name of the event type, for example "onHypothesis"
+	std::string type;
+	///The EventData as written by EventData::serialize(), read it with a PayloadReader
+	std::string payload;
+	///True if the payload was too long for the bus and was cut short
+	bool truncated;
+};
+
+///\brief Reads the events Buckey publishes to its EventBus from any local process.
+///
+///		Reading is a couple of loads and a copy out of shared memory, no system calls are made once the bus is mapped and nothing is ever written to it, so any number of readers can follow the bus.
+///		A reader that falls a whole ring behind skips to the oldest message still in the ring and counts what it skipped, see getMissed().
+///		Only this header, EventBusLayout.h and EventBusReader.cpp are needed, link with -lrt on older C libraries.
+class EventBusReader
+{
+	public:
+		EventBusReader();
+		~EventBusReader();
+
+		///\brief Maps the bus of the given name and starts at its newest message, or at the oldest one still in the ring if fromOldest is true
+		///\return false if the bus does not exist, is not ready, or is of another version
+		bool open(const std::string & name = EVENT_BUS_NAME, bool fromOldest = false);
+
+		///Unmaps the bus
+		void close();
+
+		///Returns true if a bus is mapped and the Buckey that made it has not closed it
+		bool isOpen() const;
+
+		///\brief Reads the next message if there is one
+		///\return false if the reader has caught up with Buckey, or the bus was closed
+		bool next(EventBusMessage & message);
+
+		///Returns the number of messages that were overwritten before this reader got to them
+		uint64_t getMissed() const;
+
+	protected:
+		const EventBusHeader * header;
+		const EventBusSlot * slots;
+		///Number of the next message to read
+		uint64_t position;
+		///EventBusHeader::epoch that position counts in
+		uint64_t epoch;
+		uint64_t missed;
+};
+
+#endif // EVENTBUSREADER_H
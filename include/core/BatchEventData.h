@@ -0,0 +1,41 @@
+#ifndef BATCHEVENTDATA_H
+#define BATCHEVENTDATA_H
+#include <memory>
+#include <vector>
+#include <utility>
+
+#include <EventData.h>
+#include <EventTypes.h>
+
+///\brief EventData handed to a coalescing event listener, holds every event that arrived during its coalescing window.
+///
+///See the coalesceWindow argument of EventSource::addListener()
+class BatchEventData : public EventData
+{
+	public:
+		BatchEventData();
+		virtual ~BatchEventData();
+
+		///\brief Adds an event to the end of the batch
+		///\param type [in] The type of the event
+		///\param data [in] The EventData the event was triggered with
+		void add(EventTypeID type, const std::shared_ptr<EventData> & data);
+
+		///Adds every event of another batch to the end of this one
+		void append(const BatchEventData & other);
+
+		///Returns the number of events in the batch
+		std::size_t size();
+
+		///Returns the type of the event at index, in the order the events were triggered
+		EventTypeID getType(std::size_t index);
+
+		///Returns the EventData of the event at index. It is only valid until the listener returns, like any other EventData.
+		EventData * getEvent(std::size_t index);
+
+	protected:
+		///The batched events, oldest first
+		std::vector<std::pair<EventTypeID, std::shared_ptr<EventData>>> events;
+};
+
+#endif // BATCHEVENTDATA_H
@@ -0,0 +1,166 @@
+#ifndef BLOCKINGQUEUE_H
+#define BLOCKINGQUEUE_H
+#include <mutex>
+#include <deque>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+
+///\brief A queue any number of threads can push to and pop from, where poppers sleep until there is something for them instead of polling.
+///
+///		A popper can also pass a condition that has to hold before it takes an item, for example Buckey's input watcher only takes input outside of conversations.
+///		Whoever changes what such a condition depends on calls wake() so the waiting poppers check it again.
+///		close() wakes every popper for good, pops return false once the queue is closed and empty.
+///		A queue given a capacity makes pushers wait while it is full, so a slow popper holds back whoever feeds it instead of letting the queue grow.
+template<typename T>
+class BlockingQueue
+{
+	public:
+		///\param capacity Most items the queue holds before push() waits, 0 for no limit
+		BlockingQueue(std::size_t capacity = 0) : capacity(capacity), closed(false), wakeups(0), fullWaits(0) {}
+
+		///Adds an item to the back of the queue and wakes the poppers, waiting for room first if the queue is full. Returns false and drops the item if the queue is closed.
+		bool push(const T & item) {
+			std::unique_lock<std::mutex> l(lock);
+			if(capacity > 0 && items.size() >= capacity && !closed) {
+				fullWaits++;
+				while(items.size() >= capacity && !closed) {
+					space.wait(l);
+				}
+			}
+			if(closed) {
+				return false;
+			}
+			items.push_back(item);
+			l.unlock();
+			// Every popper may have its own condition, so one of them being woken is not enough
+			ready.notify_all();
+			return true;
+		}
+
+		///Adds an item like push() but gives up instead of waiting if the queue is full, returns false if the item was not added
+		bool tryPush(const T & item) {
+			std::unique_lock<std::mutex> l(lock);
+			if(closed || (capacity > 0 && items.size() >= capacity)) {
+				return false;
+			}
+			items.push_back(item);
+			l.unlock();
+			ready.notify_all();
+			return true;
+		}
+
+		///\brief Waits until there is an item and takes it
+		///\return false if the queue was closed and emptied instead
+		bool pop(T & item) {
+			return pop(item, nullptr);
+		}
+
+		///\brief Waits until there is an item and canTake returns true, then takes it. canTake is called with the queue locked.
+		///\return false if the queue was closed instead, leftover items are only handed out by the pops without a condition
+		bool pop(T & item, const std::function<bool()> & canTake) {
+			std::unique_lock<std::mutex> l(lock);
+			while(!closed && (items.empty() || (canTake && !canTake()))) {
+				ready.wait(l);
+				wakeups++;
+			}
+			if(closed && canTake) { // Its condition may not hold, so do not hand out leftovers
+				return false;
+			}
+			return take(item);
+		}
+
+		///\brief Like pop(T &) but gives up at the deadline
+		///\return false if the deadline passed or the queue was closed before there was an item
+		template<typename Clock, typename Duration>
+		bool popUntil(T & item, const std::chrono::time_point<Clock, Duration> & deadline) {
+			std::unique_lock<std::mutex> l(lock);
+			while(!closed && items.empty()) {
+				if(ready.wait_until(l, deadline) == std::cv_status::timeout) {
+					break;
+				}
+				wakeups++;
+			}
+			return take(item);
+		}
+
+		///Takes the front item if there is one without waiting, returns false if there was none
+		bool tryPop(T & item) {
+			std::lock_guard<std::mutex> l(lock);
+			return take(item);
+		}
+
+		///Wakes every waiting popper to check its condition again
+		void wake() {
+			// Taking the lock makes sure a popper that just found its condition false is already waiting, otherwise it could miss this wake up
+			lock.lock();
+			lock.unlock();
+			ready.notify_all();
+		}
+
+		///Refuses further pushes and wakes every popper and waiting pusher, items already queued can still be popped
+		void close() {
+			lock.lock();
+			closed = true;
+			lock.unlock();
+			ready.notify_all();
+			space.notify_all();
+		}
+
+		bool isClosed() {
+			std::lock_guard<std::mutex> l(lock);
+			return closed;
+		}
+
+		bool empty() {
+			std::lock_guard<std::mutex> l(lock);
+			return items.empty();
+		}
+
+		std::size_t size() {
+			std::lock_guard<std::mutex> l(lock);
+			return items.size();
+		}
+
+		///Returns the number of times a waiting popper was woken up, an idle queue should not be counting up
+		unsigned long long getWakeups() {
+			std::lock_guard<std::mutex> l(lock);
+			return wakeups;
+		}
+
+		///Returns the number of pushes that had to wait because the queue was full
+		unsigned long long getFullWaits() {
+			std::lock_guard<std::mutex> l(lock);
+			return fullWaits;
+		}
+
+		std::size_t getCapacity() const {
+			return capacity;
+		}
+
+	protected:
+		///Moves the front item out, the lock must be held
+		bool take(T & item) {
+			if(items.empty()) {
+				return false;
+			}
+			item = items.front();
+			items.pop_front();
+			if(capacity > 0) {
+				space.notify_one();
+			}
+			return true;
+		}
+
+		const std::size_t capacity;
+		std::mutex lock;
+		std::condition_variable ready;
+		///Signalled when a pop makes room in a full queue
+		std::condition_variable space;
+		std::deque<T> items;
+		bool closed;
+		unsigned long long wakeups;
+		unsigned long long fullWaits;
+};
+
+#endif // BLOCKINGQUEUE_H
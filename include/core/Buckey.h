@@ -5,7 +5,9 @@
 #include "stdio.h"
 #include "stdarg.h"
 #include <mutex>
-#include <queue>
+#include <unordered_map>
+#include <deque>
+#include <future>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -16,6 +18,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/epoll.h>
 
 #include "yaml-cpp/yaml.h"
 
@@ -34,6 +37,11 @@
 #include "EchoMode.h"
 
 #include "EventSource.h"
+#include "BlockingQueue.h"
+#include "InputPipeline.h"
+#include "CommandBatch.h"
+#include "CommandDebouncer.h"
+#include "ModeExecutor.h"
 #include "ModeControlEventData.h"
 #include "ServiceControlEventData.h"
 #include "ReplyType.h"
@@ -43,42 +51,51 @@
 #include "cppfs/fs.h"
 
 #include "DynamicGrammar.h"
+#include "GrammarMatcher.h"
+#include "MatchCache.h"
+#include "RootGrammarSnapshot.h"
 #include "alternativeset.h"
 #include "sequence.h"
 
-#define ONINPUT "onInputEvent"
-#define ONOUTPUT "onOutputEvent"
-
-#define ONCONVERSATIONSTART "onConversationStartEvent"
-#define ONCONVERSATIONEND "onConversationEndEvent"
-
-#define ONENTERPROMPT "onEnterPromptEvent"
-#define ONEXITPROMPT "onExitPromptEvent"
-
-#define ONMODEREGISTER "onModeRegisterEvent"
-#define ONMODEENABLE "onModeEnableEvent"
-#define ONMODEDISABLE "onModeDisableEvent"
-#define ONMODESTART "onModeStartEvent"
-#define ONMODESTOP "onModeStopEvent"
-
-#define ONSERVICEREGISTER "onServiceRegisterEvent"
-#define ONSERVICEENABLE "onServiceEnableEvent"
-#define ONSERVICEDISABLE "onServiceDisableEvent"
-#define ONSERVICESTOP "onServiceStopEvent"
-#define ONSERVICESTART "onServiceStartEvent"
-
-#define ONFINISHINIT "onFinishInitEvent"
+// The names and EventTypeIDs of the events Buckey triggers (ONOUTPUT, ONOUTPUT_ID, ...) are defined in EventTypes.h
 
 #define SOCKET_BUFFER_SIZE 64
 #define MAX_COMMAND_SIZE 70
+///Most bytes read from a connection to the UNIX socket at once
+#define SOCKET_READ_SIZE 4096
+///Most clients connected to the UNIX socket at once, like the console, a GUI and home automation bridges
+#define MAX_SOCKET_CLIENTS 32
+///Most events taken from epoll at once by the reactor of the UNIX socket
+#define SOCKET_EVENTS 16
+///Most bytes of replies kept for a connection to the UNIX socket that is not reading them, later replies are dropped for it until it catches up
+#define SOCKET_OUTPUT_LIMIT 65536
+///Socket line that starts a batch of commands, optionally followed by the most commands of it in the pipeline at once. The batch ends with the line BATCH_END_QUERY.
+#define BATCH_QUERY "?batch"
+#define BATCH_END_QUERY "?end"
 
 #define LOG_FILE "buckey.log"
 
+///Word every command has to start with, the first part of the root grammar
+#define ROOT_COMMAND_PREFIX "buckey"
+
+// Default flow control of onOutputEvent, so a Mode replying in a loop cannot start a handler per message. Once both are used up the replying thread waits, no output is dropped unless buckey.yaml asks for it.
+#define DEFAULT_OUTPUT_IN_FLIGHT 4
+#define DEFAULT_OUTPUT_QUEUE 32
+
+// Default confirm.gram, written to the assets of SphinxService when it is missing. Sphinx listens with that file while prompting and answers to promptConfirmation() are matched against it, the {yes} and {no} tags decide the answer.
+#define CONFIRM_GRAMMAR "#JSGF v1.0;\n\
+grammar confirm;\n\
+public <command> = <positive> {yes} | <deny> {no};\n\
+<positive> = yes | yeah | ok | positive | confirm | of course | please do | yes sir;\n\
+<deny> = no | deny | reject | [please] don't | nope | do not;"
+#define CONFIRM_YES_TAG "yes"
+
 typedef std::pair<bool, Service *> serviceListEntry;
 typedef std::pair<bool, Mode *> modeListEntry;
 
-typedef std::vector<serviceListEntry> servicesList;
-typedef std::vector<modeListEntry> modesList;
+///Deques, so entries stay where they are while more are registered and pointers to them can be kept
+typedef std::deque<serviceListEntry> servicesList;
+typedef std::deque<modeListEntry> modesList;
 
 ///\brief The core class that is created and manages services, modes, input and output for the Buckey program
 class Buckey : public EventSource {
@@ -100,6 +117,9 @@ class Buckey : public EventSource {
 		///Requests for the instance to stop running, sets killed to true.
 		void requestStop();
 
+		///Requests a stop from a signal handler. Only sets killed and wakes the unix socket manager, which finishes the stop with requestStop().
+		void requestStopFromSignal();
+
 
 		void reload();
 
@@ -123,10 +143,13 @@ class Buckey : public EventSource {
         static void logInfo(std::string message);
         static void logWarn(std::string message);
         static void logError(std::string message);
+        ///Returns a report of the trigger counts, queueing delays and run times of every event listener, see EventStatistics
+        std::string getEventStatistics();
 
         //Input
-        void passInput(std::string input);
-        void passCommand(std::string command);
+        void passInput(std::string input, const std::string & source = INPUT_SOURCE_INTERNAL);
+        void passCommand(std::string command, const std::string & source = INPUT_SOURCE_INTERNAL);
+        CommandBatch * startCommandBatch(unsigned int concurrency = DEFAULT_BATCH_CONCURRENCY);
 
         //Output & Conversation
         void startConversation();
@@ -134,6 +157,7 @@ class Buckey : public EventSource {
         bool isInConversation();
         void reply(std::string message, ReplyType type);
         PromptResult * promptConfirmation(const std::string & prompt, int timeout = 7);
+        std::future<PromptResult *> promptConfirmationAsync(const std::string & prompt, int timeout = 7);
 
         //Sound
 		bool isMakingSound();
@@ -142,6 +166,7 @@ class Buckey : public EventSource {
 
         //Modes
         DynamicGrammar * getRootGrammar();
+        std::string getRootGrammarText();
         void addModeToRootGrammar(const Mode * m, DynamicGrammar * g);
         void removeModeFromRootGrammar(const Mode * m, DynamicGrammar * g);
         const void listEnabledModes(std::vector<std::string> & output);
@@ -154,6 +179,7 @@ class Buckey : public EventSource {
         void reloadMode(const std::string & name);
         void stopMode(const std::string & name);
         void startMode(const std::string & name);
+        void cancelMode(const std::string & name);
         const ModeState getModeState(const std::string & name);
 
 		//Singleton implementation
@@ -175,6 +201,23 @@ class Buckey : public EventSource {
         	return instance;
         };
 
+        ///\brief Returns the Buckey that replays an EventJournal, making it if there is no Buckey yet
+        ///
+        ///		It registers every Mode and Service but only enables the Modes, whose listeners the replayed events are for. No Service is enabled, so nothing listens to the microphone or speaks.
+        ///		It opens no UNIX socket, plays no sounds, publishes nothing on the event bus and leaves services.enabled and modes.enabled as they are.
+        static Buckey * getReplayInstance(cppfs::FileHandle configDir, cppfs::FileHandle assetsDir, cppfs::FileHandle tempDir) {
+        	if(!instanceSet) {
+				instanceSet = true;
+				instance = new Buckey(configDir, assetsDir, tempDir);
+				instance->replaying = true;
+				instance->init();
+        	}
+        	return instance;
+        };
+
+        ///Returns true for the Buckey made by getReplayInstance()
+        bool isReplaying() const;
+
     protected:
     	Buckey();
         Buckey(cppfs::FileHandle configDir, cppfs::FileHandle assetsDir, cppfs::FileHandle tempDir);
@@ -183,10 +226,20 @@ class Buckey : public EventSource {
     	//General
     	std::atomic<bool> running;
     	std::atomic<bool> killed;
-    	///Bool is true if Service is enabled on startup
-    	std::vector<std::pair<bool, Service *>> services;
-    	///Bool is true if Mode is enabled on startup
-    	std::vector<std::pair<bool, Mode *>> modes;
+    	///Set by getReplayInstance() before init()
+    	bool replaying;
+    	///Bool is true if Service is enabled on startup, in the order they were registered
+    	servicesList services;
+    	///Bool is true if Mode is enabled on startup, in the order they were registered
+    	modesList modes;
+    	///The entries of services and modes by name
+    	std::unordered_map<std::string, serviceListEntry *> serviceIndex;
+    	std::unordered_map<std::string, modeListEntry *> modeIndex;
+    	///Locked when touching serviceIndex or modeIndex, or adding to services or modes. The input pipeline workers look Modes up while Modes may still be registered.
+    	std::mutex indexLock;
+    	///Returns the entry of the Service or Mode with the given name, nullptr if none is registered
+    	serviceListEntry * findService(const std::string & name);
+    	modeListEntry * findMode(const std::string & name);
 
     	//Conversation
     	///Locked when a conversation is occurring. This way only 1 conversation happens at a time.
@@ -194,12 +247,43 @@ class Buckey : public EventSource {
     	std::atomic<bool> inConversation;
 
     	//Input Que
-    	std::queue<std::string> inputQue;
-    	/// Locked when adding or reading from the inputQue vector
-    	std::mutex inputQueMutex;
+    	///Input and the source it came from waiting for a command or prompt, closed by requestStop() to wake everyone waiting on it
+    	BlockingQueue<std::pair<std::string, std::string>> inputQue;
+    	///Number of prompts waiting for an answer, the inputWatcher leaves input alone while there are any
+    	std::atomic<unsigned int> prompting;
+    	///The parsed confirm.gram of SphinxService, only matched against with promptLock locked
+    	Grammar * confirmGrammar;
+    	///Called in init() once the services are registered, parses confirmGrammar
+    	void loadConfirmGrammar();
+    	std::mutex promptLock;
+    	PromptResult * waitForConfirmation(std::chrono::steady_clock::time_point deadline);
+
+    	//Input Pipeline
+    	///Takes commands from passCommand() through filtering and grammar matching to their Mode
+    	InputPipeline * inputPipeline;
+    	void setupInputPipeline();
+    	///Match stage of the inputPipeline, finds the Mode of the command in the root grammar
+    	bool matchCommand(PipelineCommand & command);
+    	///Dedup stage of the inputPipeline, drops repeats with the debouncer
+    	bool dedupCommand(PipelineCommand & command);
+    	///Decides which commands are repeats, set up from the dedup settings of buckey.yaml and the repeat windows of Modes
+    	CommandDebouncer debouncer;
+    	///Dispatch stage of the inputPipeline, queues the command on the ModeExecutor of its Mode
+    	bool dispatchCommand(PipelineCommand & command);
+    	///Runs the commands of every registered Mode, created by registerMode()
+    	std::unordered_map<const Mode *, ModeExecutor *> modeExecutors;
+    	///Locked when touching modeExecutors
+    	std::mutex modeExecutorsLock;
+    	ModeExecutor * getModeExecutor(const Mode * m);
     	std::thread inputWatcher;
     	static void watchInputQue(Buckey * b);
 
+    	//Event Journal
+    	///EventJournal decoder of the Mode control events, finds the Mode of the recorded name
+    	static EventData * decodeModeControl(PayloadReader & in);
+    	///EventJournal decoder of the Service control events, finds the Service of the recorded name
+    	static EventData * decodeServiceControl(PayloadReader & in);
+
     	//Sounds
     	void initAudio();
     	std::atomic<unsigned short> soundsPlayingCount;
@@ -209,11 +293,40 @@ class Buckey : public EventSource {
 
     	//UNIX Socket Stuff
 		std::thread socketManagementThread;
-		int socketHandle, socket2Handle;
-		struct sockaddr_un local, remote;
+		int socketHandle;
+		///eventfd that wakes manageUnixSocket() when Buckey stops or a CommandBatch of a client has room again
+		int socketWakeHandle;
+		struct sockaddr_un local;
 		void makeServerSocket();
 		static void manageUnixSocket();
-		std::atomic<bool> socketConnected;
+		void wakeSocketManager();
+
+		///\brief One connection to the UNIX socket, only touched by manageUnixSocket()
+		struct SocketClient {
+			SocketClient() : skipping(false), batch(nullptr), hungUp(false), writing(false), watching(EPOLLIN) {}
+
+			///Start of the next line, until its newline comes in
+			std::string partial;
+			///Set while the rest of a line longer than MAX_COMMAND_SIZE is thrown away
+			bool skipping;
+			///Lines received but not handled yet, only left over while the batch of the client is full or ending
+			std::deque<std::string> lines;
+			///Batch the client is sending, if any
+			CommandBatch * batch;
+			///Set once the client sends nothing more
+			bool hungUp;
+			///Set while some of its entry in socketOutput could not be written yet
+			bool writing;
+			///Events epoll watches the connection for, 0 if it is not watched. There is no EPOLLIN while lines are left over, so the client waits on its socket.
+			unsigned int watching;
+		};
+
+		///Connections that replies are sent to
+		std::vector<int> socketClients;
+		///Bytes waiting to be written to each connection, added to by reply() and the answers of manageUnixSocket(), which writes them once the connection has room
+		std::unordered_map<int, std::string> socketOutput;
+		///Locked when touching socketClients or socketOutput
+		std::mutex socketClientsLock;
 
     	//Config handles
     	cppfs::FileHandle coreConfigDir;
@@ -231,6 +344,16 @@ class Buckey : public EventSource {
     	shared_ptr<AlternativeSet> modeList;
     	shared_ptr<Sequence> rootExpansion;
     	std::mutex rootGrammarLock;
+    	///The Mode rules of the root grammar compiled for matching, locked with rootGrammarLock
+    	GrammarMatcher rootMatcher;
+    	///Moved every time a Mode rule or variable of the root grammar changes, locked with rootGrammarLock
+    	unsigned long rootGrammarGeneration;
+    	///The version of the root grammar commands are matched against. Only swapped with std::atomic_store() under rootGrammarLock, read with std::atomic_load() without it.
+    	std::shared_ptr<const RootGrammarSnapshot> rootSnapshot;
+    	void publishRootGrammar();
+    	std::shared_ptr<const RootGrammarSnapshot> getRootGrammarSnapshot();
+    	///Matches of recently passed commands, valid for one rootGrammarGeneration
+    	MatchCache matchCache;
 
     	static bool instanceSet;
     	static Buckey * instance;
@@ -0,0 +1,67 @@
+#ifndef COMMANDBATCH_H
+#define COMMANDBATCH_H
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <functional>
+#include <condition_variable>
+
+#include "InputPipeline.h"
+#include "LatencyHistogram.h"
+
+///Default number of commands of a CommandBatch that may be in the InputPipeline at once
+#define DEFAULT_BATCH_CONCURRENCY 32
+
+///\brief Feeds many commands into an InputPipeline, keeping at most a set number of them in it at once, and measures how fast they go through.
+///
+///		submit() waits while the batch has as many commands in the pipeline as it may, so a large batch does not fill the pipeline queues and hold up commands from the user.
+///		Callers that can not wait, like the reactor of the UNIX socket, check isFull() before submit() and are told by the room callback when to go on.
+///		The latency of a command is the time from submit() until the dispatch stage handed it to its Mode, or until a stage dropped it.
+class CommandBatch
+{
+	public:
+		///\param concurrency Most commands of the batch in the pipeline at once, 0 is taken as 1
+		CommandBatch(InputPipeline & pipeline, unsigned int concurrency = DEFAULT_BATCH_CONCURRENCY);
+		///Waits for the commands still in the pipeline
+		virtual ~CommandBatch();
+
+		///\brief Enters a command into the pipeline, waiting first if the batch has too many in it
+		///\return false if the pipeline is stopped
+		bool submit(const std::string & command);
+
+		///Returns true if the batch has as many commands in the pipeline as it may, so submit() would wait
+		bool isFull();
+
+		///Returns true if no command of the batch is in the pipeline
+		bool isIdle();
+
+		///Sets a function called from the pipeline threads when a command leaves the batch while it was full, or the last command leaves it. Set it before submit().
+		void setRoomCallback(const std::function<void()> & callback);
+
+		///Waits until every submitted command has left the pipeline
+		void finish();
+
+		///Returns a report of the number of commands, the commands per second and the latencies of the batch, call finish() first
+		std::string report();
+
+	protected:
+		///Done function given to the pipeline with every command
+		void commandDone(const PipelineCommand & command, bool dispatched);
+
+		InputPipeline & pipeline;
+		const unsigned int concurrency;
+		std::function<void()> roomCallback;
+
+		///Locked when touching everything below
+		std::mutex batchLock;
+		std::condition_variable left;
+		unsigned int inPipeline;
+		unsigned long long submitted;
+		unsigned long long dispatched;
+		unsigned long long dropped;
+		LatencyHistogram latency;
+		std::chrono::steady_clock::time_point started;
+		std::chrono::steady_clock::time_point finished;
+};
+
+#endif // COMMANDBATCH_H
@@ -0,0 +1,68 @@
+#ifndef COMMANDDEBOUNCER_H
+#define COMMANDDEBOUNCER_H
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+///Default milliseconds in which a repeated command is dropped, for Modes without a window of their own. 0 passes every repeat.
+#define DEFAULT_DEDUP_WINDOW 0
+///Number of remembered commands past which the ones older than every window are forgotten
+#define DEDUP_PRUNE_SIZE 1024
+
+///\brief Drops commands that repeat one from the same source within the repeat window of the Mode they are for.
+///
+///		Overlapping speech decoders hearing the same words and clients sending a line twice both hand Buckey the same command twice in quick succession.
+///		A command is a repeat if the same normalized text came from the same source less than the window of its Mode ago, counted from the last time it was let through.
+///		Modes set their window with Mode::getRepeatWindow(), buckey.yaml can override it under dedup. Sources can be exempted, like command batches that repeat commands on purpose.
+class CommandDebouncer
+{
+	public:
+		CommandDebouncer();
+
+		///Sets the window of Modes that have none of their own, in milliseconds
+		void setDefaultWindow(unsigned int window);
+
+		///Sets the window of a Mode in milliseconds, 0 lets every repeat through
+		void setModeWindow(const std::string & mode, unsigned int window);
+
+		///Returns the window of a Mode in milliseconds
+		unsigned int getWindow(const std::string & mode);
+
+		///Lets every command from the source through, however often it repeats
+		void exemptSource(const std::string & source);
+
+		///Removes every exempted source
+		void clearExemptSources();
+
+		///\brief Decides if a command goes on or is a repeat
+		///\param command The normalized text of the command
+		///\param source Where the command came from, see PipelineCommand::source
+		///\param mode Name of the Mode the command matched
+		///\param when When the command came in
+		///\return false if the command is a repeat and should be dropped
+		bool accept(const std::string & command, const std::string & source, const std::string & mode, std::chrono::steady_clock::time_point when);
+
+		///Returns a one line report of the commands let through and dropped
+		std::string report();
+
+	protected:
+		///Forgets the commands older than the longest window. Must be called with debounceLock locked.
+		void prune(std::chrono::steady_clock::time_point now);
+
+		///Locked when touching everything below
+		std::mutex debounceLock;
+		unsigned int defaultWindow;
+		std::unordered_map<std::string, unsigned int> modeWindows;
+		///Longest of defaultWindow and modeWindows
+		unsigned int longestWindow;
+		std::vector<std::string> exemptSources;
+		///When each source and command pair was last let through
+		std::unordered_map<std::string, std::chrono::steady_clock::time_point> lastAccepted;
+
+		unsigned long long accepted;
+		unsigned long long dropped;
+};
+
+#endif // COMMANDDEBOUNCER_H
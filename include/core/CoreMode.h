@@ -7,6 +7,9 @@
 #include <string>
 #include "EventData.h"
 
+///Milliseconds that mode and service events are collected for before CoreMode rebuilds its grammar once for all of them
+#define GRAMMAR_UPDATE_WINDOW 250
+
 ///\brief The mode this is always enabled by Buckey that allows for mangement of modes and services.
 class CoreMode : public Mode
 {
@@ -27,7 +30,7 @@ class CoreMode : public Mode
 		///Event handler that is attached to Buckey that is called once all Modes and Services are registered and enabled
 		static void initFinished(EventData * data, std::atomic<bool> * done);
 
-		///Event handler that is attached to Buckey that is called whenever a Mode or Service changes states
+		///Event handler that is attached to Buckey that is called whenever a Mode or Service changes states, receives a BatchEventData of every change within GRAMMAR_UPDATE_WINDOW
 		static void updateGrammar(EventData * data, std::atomic<bool> * done);
 
 	protected:
@@ -0,0 +1,20 @@
+#ifndef DISPATCHPOLICY_H
+#define DISPATCHPOLICY_H
+
+///\brief Where a triggered event listener is ran, chosen per listener when calling EventSource::addListener()
+enum class DispatchPolicy
+{
+	///Runs on one of the EventDispatcher's workers, or on a dedicated thread if event-workers is set to 0
+	DEFAULT,
+	///Runs on the thread that triggered the event, before triggerEvents() returns. Only meant for listeners that return right away and never block.
+	INLINE,
+	///Always runs on one of the EventDispatcher's workers
+	POOLED,
+	///Always runs on a new std::thread of its own, for listeners that block for a long time
+	DEDICATED,
+	///Runs on one of the EventDispatcher's workers like POOLED, but never alongside itself: its calls run one at a time in the order they were triggered.
+	///Other listeners are not held up by it. Falls back to dedicated threads, still one at a time, if event-workers is set to 0.
+	SERIAL
+};
+
+#endif // DISPATCHPOLICY_H
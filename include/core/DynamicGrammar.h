@@ -36,6 +36,12 @@ class DynamicGrammar : public Grammar
 
         std::vector<std::string> listVariables();
 
+        ///Returns a number that goes up every time setVariable() changes the grammar, so compiled copies of it know when they are out of date
+        unsigned long getGeneration() const;
+
+        ///Returns a number that goes up every time setVariable() changes any DynamicGrammar, so copies of grammars that took in their rules know to look for changes
+        static unsigned long getChangeCount();
+
         /// Kinda a hack, but should be called once the risk of collision between IDs is low and running out of space for IDs (ie, program has been running for months and used a TON of dynamic grammars)
         static void resetNextID();
 
@@ -46,9 +52,15 @@ class DynamicGrammar : public Grammar
 		///Called when constructing the DynamicGrammar after the base Grammar class parses all of the Expansions
 		void walkoverExpansion(DynamicGrammar *, Expansion * e);
 
+		///Bumped by setVariable()
+		std::atomic<unsigned long> generation;
+
 		/// This is a unique ID to ensure that when dynamic grammars are fused together the variable names do not conflict
 		unsigned long id;
 
+		///Bumped by setVariable() of every DynamicGrammar
+		static std::atomic<unsigned long> changes;
+
 		///ID of the next DynamicGrammar constructed. Do not access this unless you lock the idLock mutex!
 		static unsigned long nextID;
 
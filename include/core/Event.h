@@ -0,0 +1,55 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <EventData.h>
+#include <EventTypes.h>
+
+///\brief Describes an event type whose listeners receive a typed payload instead of an EventData pointer.
+///
+///		Typed listeners are plain functions taking a const reference to the Payload, see EventSource::addListener(const Event<Payload> &, ...).
+///		The payload is copied into the dispatch record of each listener, so small payloads cost no heap allocation of their own and there is no done flag to set.
+///		An Event may be given a converter to EventData, in which case listeners registered with the EventData API on the same EventTypeID are still called, with the converted EventData.
+///		It may also be given a converter back from EventData, which lets typed listeners receive events replayed from the EventJournal.
+template<typename Payload>
+class Event
+{
+	public:
+		///Builds a legacy EventData from the payload, the EventSource takes ownership of it
+		typedef EventData * (*LegacyConverter)(const Payload &);
+
+		///Fills in the payload from a legacy EventData, returns false if the EventData is not of the expected type
+		typedef bool (*PayloadConverter)(EventData *, Payload &);
+
+		///\brief Describes the typed event with the given ID
+		///\param id [in] Event type ID shared with the EventData API
+		///\param toLegacy [in] Used to call EventData listeners of the same ID, they are skipped if this is nullptr
+		///\param fromLegacy [in] Used to call typed listeners with replayed events, they are skipped on replay if this is nullptr
+		explicit Event(EventTypeID id, LegacyConverter toLegacy = nullptr, PayloadConverter fromLegacy = nullptr) : id(id), toLegacy(toLegacy), fromLegacy(fromLegacy) {}
+
+		///Returns the event type ID
+		EventTypeID getID() const {
+			return id;
+		}
+
+		///Returns true if EventData listeners of the same ID can be called
+		bool hasLegacyConverter() const {
+			return toLegacy != nullptr;
+		}
+
+		///Builds the EventData handed to EventData listeners, or nullptr if there is no converter
+		EventData * toEventData(const Payload & payload) const {
+			return toLegacy == nullptr ? nullptr : toLegacy(payload);
+		}
+
+		///Returns the converter from EventData, or nullptr if there is none
+		PayloadConverter getPayloadConverter() const {
+			return fromLegacy;
+		}
+
+	protected:
+		EventTypeID id;
+		LegacyConverter toLegacy;
+		PayloadConverter fromLegacy;
+};
+
+#endif // EVENT_H
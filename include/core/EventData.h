@@ -1,6 +1,10 @@
 #ifndef EVENTDATA_H
 #define EVENTDATA_H
 #include <string>
+#include <cstddef>
+
+#include <PayloadReader.h>
+#include <PayloadWriter.h>
 
 ///This is a class that should hold data about an event that was triggered. It is highly recommended to extend this class for specific use cases.
 class EventData
@@ -15,6 +19,15 @@ class EventData
         ///Construct holding an int as data
         EventData(int i);
         virtual ~EventData();
+        ///Allocates EventData objects from a per-type ObjectPool so hot events do not hit the global heap
+        static void * operator new(std::size_t size);
+        ///Returns the memory of a deleted EventData to its ObjectPool
+        static void operator delete(void * p, std::size_t size);
+
+        ///Writes the stored data for the EventJournal. Subclasses that hold anything else override this, and hand a matching decoder to EventJournal::setDecoder().
+        virtual void serialize(PayloadWriter & out) const;
+        ///Rebuilds an EventData written by EventData::serialize(), the default EventJournal decoder
+        static EventData * deserialize(PayloadReader & in);
 
         ///Returns the stored boolean value, if there was one
         bool getBool();
@@ -0,0 +1,189 @@
+#ifndef EVENTDISPATCHER_H
+#define EVENTDISPATCHER_H
+#include <map>
+#include <deque>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+#include <EventPriority.h>
+
+///The smallest number of workers the shared EventDispatcher is started with when no worker count is configured
+#define DEFAULT_EVENT_WORKERS 4
+
+///Default deadline in milliseconds of REALTIME tasks, see EventDispatcher::setDeadline()
+#define DEFAULT_REALTIME_DEADLINE 50
+///Default deadline in milliseconds of INTERACTIVE tasks
+#define DEFAULT_INTERACTIVE_DEADLINE 250
+///Default deadline in milliseconds of BACKGROUND tasks, they have none
+#define DEFAULT_BACKGROUND_DEADLINE 0
+
+///\brief A fixed size pool of reusable worker threads that runs triggered event listeners.
+///
+///		Every EventSource hands its triggered listeners to the single shared EventDispatcher instead of starting a new std::thread per listener.
+///		Each worker owns a deque of tasks. A worker takes tasks from the front of its own deque and, once that runs dry, steals from the back of the other workers' deques.
+///		Tasks submitted from a worker thread (a listener triggering another event) stay on that worker's deque, tasks submitted from any other thread are spread round-robin.
+///		Every worker has one deque per EventPriority lane. A worker looks for REALTIME tasks in every deque before it takes any INTERACTIVE task, and so on, so background work never holds up speech.
+///		Each lane may have a deadline. A task that waited in its deque for longer than that is still ran, but counted as a deadline miss.
+class EventDispatcher
+{
+	public:
+		typedef std::function<void()> Task;
+
+		///Returns the shared EventDispatcher, starting its worker threads on the first call
+		static EventDispatcher * getInstance();
+
+		///\brief Sets the number of worker threads the shared EventDispatcher is started with.
+		///Only has an effect before the first call to getInstance(). A count of 0 disables the pool and makes EventSources start one std::thread per listener like they used to.
+		///\return true if the count will be used, false if the dispatcher was already started
+		static bool setWorkerCount(unsigned int count);
+
+		///Returns the number of worker threads the shared EventDispatcher is (or will be) started with
+		static unsigned int getWorkerCount();
+
+		///Returns true if the configured worker count is above 0
+		static bool isPooled();
+
+		///Returns true if the calling thread is one of the worker threads of the pool
+		static bool isWorkerThread();
+
+		///Queues the task in the given lane to be ran on one of the worker threads
+		void submit(Task task, EventPriority priority = EventPriority::INTERACTIVE);
+
+		///Runs the task on the timer thread once at least millis milliseconds have passed. The task should return quickly, usually by submitting the actual work.
+		void submitAfter(unsigned int millis, Task task);
+
+		///Runs the task on a new std::thread of its own. The thread is joined by the shared reaper thread once the task returns.
+		void startDedicated(Task task);
+
+		///Returns the number of tasks that are queued but not yet started
+		unsigned long queuedCount() const;
+
+		///Sets the longest a task of the lane should wait before a worker starts it, in milliseconds. 0 means the lane has no deadline.
+		static void setDeadline(EventPriority priority, unsigned int millis);
+
+		///Returns the deadline of the lane in milliseconds, 0 if it has none
+		static unsigned int getDeadline(EventPriority priority);
+
+		///Returns the number of tasks of the lane that were started after their deadline
+		unsigned long getDeadlineMisses(EventPriority priority) const;
+
+		///Returns the number of dedicated threads that have not been joined yet
+		unsigned long dedicatedCount() const;
+
+		///Runs every pending timer right away, asks all workers to finish the queued tasks, then joins them along with the reaper
+		void shutdown();
+
+		virtual ~EventDispatcher();
+
+	protected:
+		EventDispatcher(unsigned int workerCount);
+
+		///A queued task and when it was queued
+		struct QueuedTask {
+			Task task;
+			std::chrono::steady_clock::time_point queuedAt;
+		};
+
+		///A worker thread and the deques of tasks that it owns
+		struct Worker {
+			///Queued tasks indexed by EventPriority, the owner pops from the front and other workers steal from the back
+			std::deque<QueuedTask> tasks[EVENT_PRIORITY_COUNT];
+			///Locked when pushing to, popping from, or stealing from any of the tasks deques
+			std::mutex lock;
+			std::thread thread;
+		};
+
+		///\brief A thread started by startDedicated()
+		struct DedicatedThread {
+			DedicatedThread() : references(2) {}
+			std::thread thread;
+			///Released once by the thread when its task returns and once by startDedicated() after the std::thread is stored, the thread is reaped when both are done
+			std::atomic<unsigned short> references;
+		};
+
+		///Loop ran by every worker thread
+		static void runWorker(EventDispatcher * d, unsigned int index);
+
+		///Entry point of dedicated threads
+		static void runDedicated(EventDispatcher * d, DedicatedThread * t, Task task);
+
+		///Loop ran by the timer thread, sleeps until the earliest timer is due and runs it
+		static void runTimer(EventDispatcher * d);
+
+		///Loop ran by the reaper thread, sleeps until a dedicated thread finishes and then joins it
+		static void runReaper(EventDispatcher * d);
+
+		///Drops a reference to the dedicated thread, handing it to the reaper when none are left
+		void releaseDedicated(DedicatedThread * t);
+
+		///Pops a task from the worker's own deque, or steals one from another worker, highest lane first. Returns false if every deque is empty.
+		bool takeTask(unsigned int index, Task & out);
+
+		///Counts a deadline miss if the task has waited longer than the deadline of its lane
+		void checkDeadline(unsigned int lane, const QueuedTask & t);
+
+		std::vector<Worker *> workers;
+
+		///Number of tasks sitting in any of the deques, counted in by submit() before the task is pushed so it never drops below 0
+		std::atomic<unsigned long> queued;
+
+		///Deadline misses indexed by EventPriority
+		std::atomic<unsigned long> deadlineMisses[EVENT_PRIORITY_COUNT];
+
+		///Set to true when the workers should exit once the deques are empty
+		std::atomic<bool> stopping;
+
+		///Used to pick the worker deque for tasks that are not submitted from a worker thread
+		std::atomic<unsigned int> nextWorker;
+
+		///Locked by idle workers while they wait on wakeup
+		std::mutex sleepLock;
+
+		///Notified whenever a task is queued or the dispatcher is stopping
+		std::condition_variable wakeup;
+
+		///Dedicated threads whose task has returned and that are waiting to be joined
+		std::vector<DedicatedThread *> finishedThreads;
+
+		///Number of dedicated threads started but not yet joined
+		std::atomic<unsigned long> liveDedicated;
+
+		///Locked when touching finishedThreads
+		std::mutex reaperLock;
+
+		///Notified when a dedicated thread finishes or the dispatcher is stopping
+		std::condition_variable reaperWakeup;
+
+		///Joins finished dedicated threads for every EventSource
+		std::thread reaper;
+
+		///Tasks given to submitAfter(), ordered by when they are due
+		std::multimap<std::chrono::steady_clock::time_point, Task> timers;
+
+		///Locked when touching timers
+		std::mutex timerLock;
+
+		///Notified when a timer is added or the dispatcher is stopping
+		std::condition_variable timerWakeup;
+
+		///Runs the tasks given to submitAfter()
+		std::thread timer;
+
+		///Index of the worker the current thread is, or -1 if the current thread is not a worker
+		static thread_local int currentWorker;
+
+		static std::atomic<unsigned int> configuredWorkers;
+
+		///Deadlines in milliseconds indexed by EventPriority
+		static std::atomic<unsigned int> deadlines[EVENT_PRIORITY_COUNT];
+		static std::atomic<bool> instanceSet;
+		static EventDispatcher * instance;
+		static std::mutex instanceLock;
+};
+
+#endif // EVENTDISPATCHER_H
@@ -0,0 +1,150 @@
+#ifndef EVENTJOURNAL_H
+#define EVENTJOURNAL_H
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <unordered_map>
+#include <condition_variable>
+
+#include <EventData.h>
+#include <EventTypes.h>
+#include <PayloadReader.h>
+#include <PayloadWriter.h>
+
+class EventSource;
+
+///Number of triggers the journal ring buffer holds before triggers are dropped from the journal, must be a power of two
+#define JOURNAL_RING_SIZE 8192
+///Milliseconds the journal writer sleeps for when the ring buffer is empty
+#define JOURNAL_WRITER_INTERVAL 20
+///First bytes of every journal file
+#define JOURNAL_MAGIC "BUCKEYJ1"
+
+///Rebuilds the EventData of one event type from the bytes written by its EventData::serialize(), returns nullptr if it can not
+typedef EventData * (*EventDecoder)(PayloadReader & in);
+
+///\brief Records every triggered event to a binary file, and replays such a file into the running EventSources.
+///
+///		Events triggered from inside an event listener are not recorded, the listener triggers them again on replay so each event reaches its listeners once.
+///		Triggering threads only serialize the EventData into a free slot of a fixed ring buffer, a background writer thread moves the slots to the file.
+///		If the writer falls behind by a whole ring the trigger is dropped from the journal and counted, triggering never waits on the disk.
+///		EventSources are recorded under the name they give to EventSource::setJournalName(), and replayed into whichever EventSource holds that name in the replaying process.
+///		Each record holds the microseconds since the journal was opened, the source, the event type and the serialized EventData. Event type and source names are written once, the first time they are used.
+class EventJournal
+{
+	public:
+		///Returns the singleton EventJournal
+		static EventJournal * getInstance();
+
+		///Returns true if triggers are being recorded, checked by EventSource before it builds anything for the journal
+		static bool isRecording() {
+			return recording.load(std::memory_order_acquire);
+		}
+
+		///\brief Starts recording to the file at path, replacing it. Does nothing if already recording or in replay mode.
+		///\return false if the file could not be opened
+		bool open(const std::string & path);
+
+		///Stops recording, waits for the record() calls already under way, writes every trigger still in the ring buffer and closes the file
+		void close();
+
+		///Keeps open() from recording while a journal is being replayed, so a replayed journal is not overwritten by its own replay
+		void setReplayMode(bool replay);
+
+		///Returns true if setReplayMode() was turned on
+		bool isReplayMode() const;
+
+		///Copies the serialized data of a trigger into the ring buffer, called by EventSource::triggerEvents(). Does nothing once close() has started.
+		void record(uint32_t source, EventTypeID type, const EventData * data);
+
+		///\brief Triggers every event of the journal at path on the EventSource of the same name, sleeping between them to match the recorded timing if realtime is true
+		///\param replayed [out] The number of events that were triggered
+		///\param skipped [out] The number of events whose source or EventData could not be found or rebuilt
+		///\return false if the file could not be read or is not a journal
+		bool replay(const std::string & path, bool realtime, unsigned long & replayed, unsigned long & skipped);
+
+		///Sets the function that rebuilds the EventData of the event type on replay, event types without one are replayed with EventData::deserialize()
+		void setDecoder(EventTypeID type, EventDecoder decoder);
+
+		///Gives the EventSource a journal source ID under the name, replays of that name are triggered on it
+		uint32_t registerSource(const std::string & name, EventSource * source);
+
+		///Forgets the EventSource, called by its destructor
+		void unregisterSource(EventSource * source);
+
+		///Returns the number of triggers written to the file since it was opened
+		unsigned long long getWritten() const;
+
+		///Returns the number of triggers dropped because the ring buffer was full
+		unsigned long long getDropped() const;
+
+	protected:
+		EventJournal();
+
+		///\brief One trigger in the ring buffer.
+		///
+		///		sequence tells producers and the writer whose turn the slot is, like in Dmitry Vyukov's bounded queue: it is the ring position a producer may claim it at,
+		///		or that position + 1 once the trigger is filled in and the writer may take it.
+		struct Slot {
+			std::atomic<uint64_t> sequence;
+			uint64_t micros;
+			uint32_t source;
+			EventTypeID type;
+			///Kept between laps so its capacity is reused
+			std::string payload;
+		};
+
+		///Body of the writer thread
+		static void runWriter(EventJournal * j);
+
+		///Moves every filled slot to buffer, returns false if there were none
+		bool drain(std::string & buffer);
+
+		static std::atomic<bool> recording;
+
+		static EventJournal * instance;
+		static std::atomic<bool> instanceSet;
+		///Locked while creating the instance
+		static std::mutex instanceLock;
+
+		///Set while replaying, stops open()
+		std::atomic<bool> replaying;
+
+		///Locked by open() and close()
+		std::mutex fileLock;
+		FILE * file;
+		std::thread writer;
+		std::atomic<bool> stopping;
+		///Number of record() calls under way, close() waits for it to reach 0 before the last drain
+		std::atomic<unsigned int> recorders;
+		std::mutex sleepLock;
+		std::condition_variable wakeup;
+
+		Slot * ring;
+		///Next position producers claim
+		std::atomic<uint64_t> head;
+		///Next position the writer takes, only touched by the writer
+		uint64_t tail;
+		std::chrono::steady_clock::time_point openedAt;
+
+		std::atomic<unsigned long long> written;
+		std::atomic<unsigned long long> dropped;
+
+		///Event types and sources whose names were already written, only touched by the writer
+		std::vector<bool> typesWritten;
+		std::vector<bool> sourcesWritten;
+
+		///Locked when touching the source and decoder tables
+		std::mutex tableLock;
+		///Indexed by journal source ID, 0 is kept for sources without a name
+		std::vector<std::string> sourceNames;
+		std::unordered_map<std::string, EventSource *> sources;
+		std::unordered_map<EventTypeID, EventDecoder> decoders;
+};
+
+#endif // EVENTJOURNAL_H
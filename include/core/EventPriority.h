@@ -0,0 +1,20 @@
+#ifndef EVENTPRIORITY_H
+#define EVENTPRIORITY_H
+
+///The number of EventPriority lanes
+#define EVENT_PRIORITY_COUNT 3
+
+///\brief The lane pooled event listeners are queued in. Workers drain every queued REALTIME listener before touching INTERACTIVE ones, and those before BACKGROUND ones.
+///
+///The lane comes from the event type, see EventTypes::getPriority()
+enum class EventPriority
+{
+	///Speech and hypothesis events, anything the voice round trip waits on
+	REALTIME = 0,
+	///Output, prompt and conversation events, and custom event types unless told otherwise
+	INTERACTIVE = 1,
+	///Registry and lifecycle events
+	BACKGROUND = 2
+};
+
+#endif // EVENTPRIORITY_H
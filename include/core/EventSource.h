@@ -5,77 +5,425 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <memory>
 #include <algorithm>
 #include <unordered_map>
+#include <deque>
+#include <condition_variable>
 
+#include <Event.h>
 #include <EventData.h>
+#include <ObjectPool.h>
+#include <BatchEventData.h>
+#include <EventTypes.h>
+#include <DispatchPolicy.h>
+#include <FlowControl.h>
+#include <EventDispatcher.h>
+#include <EventJournal.h>
+#include <EventBus.h>
+#include <EventStatistics.h>
 
 typedef std::vector<std::pair<std::string,std::vector<void(*)(EventData *, std::atomic<bool> *)>>>::iterator HandlerIterator;
 
 ///\brief A class meant to be extended that provides event triggering and event listening capabilities to a class
 class EventSource
 {
+    friend class EventJournal;
     public:
         EventSource();
 
-        /// Adds an event listener of the specified type. The callback function should accept a pointer to an EventData object and a pointer to a atomic<bool> object. Before the callback exits it needs to set the atomic<bool> to true for thread cleanup.
-        unsigned long addListener(std::string eventType, void (*)(EventData *, std::atomic<bool> *));
+        /// Adds an event listener of the specified type. The callback function should accept a pointer to an EventData object and a pointer to a atomic<bool> object. The callback may set the atomic<bool> to true when it is done, the listener is considered finished once the callback returns either way.
+        /// The policy picks the thread the listener runs on, see DispatchPolicy.
+        /// If coalesceWindow is above 0 the listener is not called for every event. The first event starts a window of coalesceWindow milliseconds, and once it is over the listener is called once with a BatchEventData holding every event that arrived during it.
+        /// Coalescing listeners of one EventSource that share the same callback also share their batches, even across event types.
+        unsigned long addListener(EventTypeID eventType, void (*)(EventData *, std::atomic<bool> *), DispatchPolicy policy = DispatchPolicy::DEFAULT, unsigned int coalesceWindow = 0);
+
+        /// Adds an event listener for the event type name, see EventTypes::intern(). Kept for custom event types, the built in ones should use their EventTypeID.
+        unsigned long addListener(const std::string & eventType, void (*)(EventData *, std::atomic<bool> *), DispatchPolicy policy = DispatchPolicy::DEFAULT, unsigned int coalesceWindow = 0);
+
+        /// Adds a typed event listener, which is handed a const reference to the payload of every triggered event. It is considered finished once it returns.
+        /// Use unsetListener() with event.getID() to remove it. It is only handed events replayed from the EventJournal if the event has a converter from EventData.
+        template<typename Payload>
+        unsigned long addListener(const Event<Payload> & event, void (*handler)(const Payload &), DispatchPolicy policy = DispatchPolicy::DEFAULT);
 
         /// Clears all event listeners for the given eventType
-        void clearListeners(std::string eventType);
+        void clearListeners(EventTypeID eventType);
+
+        /// Clears all event listeners for the given event type name
+        void clearListeners(const std::string & eventType);
 
         /// Clear the event listener of the given handle
-        void unsetListener(std::string eventType, unsigned long id);
+        void unsetListener(EventTypeID eventType, unsigned long id);
+
+        /// Clear the event listener of the given handle, registered under the given event type name
+        void unsetListener(const std::string & eventType, unsigned long id);
 
         /// Returns the number of event listeners registered for the given eventType
-        unsigned long listenerCount(std::string eventType);
+        unsigned long listenerCount(EventTypeID eventType);
 
-        /// Returns the number of actively running threads that were triggered by events
+        /// Returns the number of event listeners registered for the given event type name
+        unsigned long listenerCount(const std::string & eventType);
+
+        /// Returns the number of triggered event listeners that are queued or running. EventStatistics breaks this down per listener.
         unsigned long handlerCount();
 
+        /// Limits how many listeners of eventType are handed to the EventDispatcher at once and how many may queue up behind them, and picks what happens to listeners triggered past both limits.
+        /// INLINE listeners are never held back. Listeners that were already triggered keep the limits they were triggered under. A maxInFlight of 0 removes the limits.
+        void setFlowControl(EventTypeID eventType, const FlowControl & limits);
+
+        /// Sets the flow control of the event type name, see EventTypes::intern()
+        void setFlowControl(const std::string & eventType, const FlowControl & limits);
+
+        /// Returns the limits of eventType, maxInFlight is 0 if it has none
+        FlowControl getFlowControl(EventTypeID eventType);
+
+        /// Returns the current counters of eventType, all 0 if it has no limits
+        FlowStatistics getFlowStatistics(EventTypeID eventType);
+
+        /// Returns a line for every flow controlled event type with its limits and counters, empty if there are none
+        std::string describeFlowControl();
+
     protected:
-        ///Triggers all events of the specified type and passes the specified args to them
-        void triggerEvents(std::string eventType, EventData * arg);
+        ///Triggers all events of the specified type and passes the specified args to them. Takes ownership of arg, it is deleted once the last listener has finished with it.
+        void triggerEvents(EventTypeID eventType, EventData * arg);
+
+        ///Triggers all events of the given event type name, see EventTypes::intern()
+        void triggerEvents(const std::string & eventType, EventData * arg);
+
+        ///Triggers a typed event. Every typed listener gets its own copy of the payload, EventData listeners of the same ID are called with event.toEventData(payload) if the event has a converter.
+        ///Typed events are only recorded by the EventJournal if they have that converter.
+        template<typename Payload>
+        void triggerEvents(const Event<Payload> & event, const Payload & payload);
+
+        ///Records the triggers of this EventSource in the EventJournal under the name, and makes this the EventSource that replays of the name are triggered on.
+        ///Triggers of EventSources without a name are recorded under an empty one and skipped on replay.
+        void setJournalName(const std::string & name);
 
         ~EventSource();
 
-    	///Called by the destructor to join all event listener threads
+    	///Called by the destructor, stops new events from firing and waits for all triggered event listeners to finish
         void killThreads();
 
     private:
+        struct FlowGate;
+        struct Strand;
+
+        ///\brief A triggered event listener that has not ran yet, the base of DispatchRecord and TypedDispatchRecord
+        struct QueuedListener {
+            virtual ~QueuedListener() {}
+            ///Calls the listener
+            virtual void call() = 0;
+            ///\brief Folds a newer run of the same listener into this one, for OverflowPolicy::MERGE
+            ///\return false if the two can not be merged, newer is left alone then
+            virtual bool merge(QueuedListener * newer) = 0;
+
+            EventSource * source;
+            ///Event type and listener ID the run is recorded under in EventStatistics
+            EventTypeID type;
+            unsigned long listener;
+            DispatchPolicy policy;
+            EventPriority priority;
+            ///When the listener was triggered
+            std::chrono::steady_clock::time_point triggeredAt;
+            ///The gate of the event type the listener went through, empty if the event type has no FlowControl
+            std::shared_ptr<FlowGate> gate;
+            ///The strand of a SERIAL listener, empty for every other policy
+            std::shared_ptr<Strand> strand;
+        };
+
+        ///\brief Everything a single triggered event listener needs to run, allocated from an ObjectPool
+        struct DispatchRecord : public QueuedListener {
+            DispatchRecord() : batchAware(false) {}
+            void call();
+            bool merge(QueuedListener * newer);
 
-        /// Locked when the event listener list is going to be invalidated or when the event listener or thread list is going to be used/invalidated.
+            void (*handler)(EventData *, std::atomic<bool> *);
+            ///Shared by every listener of the same trigger
+            std::shared_ptr<EventData> data;
+            ///True for coalescing listeners, whose data is always a BatchEventData that newer runs can be folded into.
+            ///Other listeners cast data to their own EventData subclass, so they are never merged.
+            bool batchAware;
+
+            static void * operator new(std::size_t size);
+            static void operator delete(void * p, std::size_t size);
+        };
+
+        ///\brief Everything a single triggered typed event listener needs to run, including its own copy of the payload
+        template<typename Payload>
+        struct TypedDispatchRecord : public QueuedListener {
+            TypedDispatchRecord(const Payload & p) : payload(p) {}
+            void call() {
+                ListenerScope scope;
+                handler(payload);
+            }
+            ///The newer payload replaces ours, a typed listener only ever sees one payload
+            bool merge(QueuedListener * newer) {
+                TypedDispatchRecord<Payload> * n = static_cast<TypedDispatchRecord<Payload> *>(newer);
+                if(n->handler != handler) {
+                    return false;
+                }
+                payload = n->payload;
+                return true;
+            }
+
+            void (*handler)(const Payload &);
+            Payload payload;
+
+            static void * operator new(std::size_t size) {
+                return ObjectPool<TypedDispatchRecord<Payload>>::allocate(size);
+            }
+            static void operator delete(void * p, std::size_t size) {
+                ObjectPool<TypedDispatchRecord<Payload>>::release(p, size);
+            }
+        };
+
+        ///\brief The in flight slots and waiting queue of one flow controlled event type
+        struct FlowGate {
+            FlowGate(const FlowControl & l) : limits(l) {}
+            const FlowControl limits;
+            ///Locked when touching anything below
+            std::mutex lock;
+            ///Notified whenever a queued listener leaves waiting, for triggering threads blocked by OverflowPolicy::BLOCK
+            std::condition_variable space;
+            ///Listeners handed to the EventDispatcher that have not finished, and the counters of getFlowStatistics()
+            FlowStatistics counters;
+            ///Listeners waiting for an in flight slot, oldest first
+            std::deque<QueuedListener *> waiting;
+        };
+
+        ///\brief Runs the calls of one SERIAL listener one at a time, in the order they were scheduled
+        struct Strand {
+            Strand() : busy(false) {}
+            ///Locked when touching anything below
+            std::mutex lock;
+            ///True while a call of the listener is handed to the EventDispatcher
+            bool busy;
+            ///Calls waiting for the running one to return, oldest first
+            std::deque<QueuedListener *> waiting;
+        };
+
+        /// Locked by anything that publishes a new listener table, so that concurrent changes are not lost. Triggering never takes it.
         std::mutex threadManipulationLock;
 
-        /// Setting this to true will lock additional events from firing and make the managerThread begin to close and end.
+        /// Setting this to true will lock additional events from firing.
         std::atomic<bool> requestJoin;
 
-        ///A vector of all of the event listener threads that were triggered and are running.
-        std::vector<std::pair<std::thread *,std::atomic<bool> *> *> threads; // atomic<bool> is set to false while running, an set to true when done
+        ///Number of triggered event listeners that are queued or running
+        std::atomic<unsigned long> inFlight;
+
+        ///Locked by killThreads() while it waits on drained, and by finishing listeners while they count themselves out
+        std::mutex drainLock;
 
-		///The next available event listener handle ID
-    	unsigned long nextID;
+        ///Notified by the last in flight listener to finish
+        std::condition_variable drained;
+
+		///The next available event listener handle ID, shared by every EventSource so IDs are unique in EventStatistics
+    	static unsigned long nextID;
 
     	///Locked whenever reading or writing to the nextID variable
-    	std::mutex idLock;
+    	static std::mutex idLock;
+
+        ///Number of listeners the current thread is running, nested INLINE listeners count once each
+        static thread_local unsigned int listenerDepth;
+
+        ///\brief Counts the current thread into listenerDepth while a listener runs
+        ///
+        ///		Events triggered by a listener are left out of the EventJournal, the listener triggers them again when the journal is replayed.
+        struct ListenerScope {
+            ListenerScope() { listenerDepth++; }
+            ~ListenerScope() { listenerDepth--; }
+        };
+
+        ///\brief A registered event listener
+        struct Listener {
+            ///Handle returned by addListener()
+            unsigned long id;
+            ///nullptr for typed listeners
+            void (*handler)(EventData *, std::atomic<bool> *);
+            ///The void (*)(const Payload &) of typed listeners, nullptr for EventData listeners
+            void (*typedHandler)();
+            DispatchPolicy policy;
+            ///Milliseconds to collect events for before calling the handler with a BatchEventData, 0 to call it for every event
+            unsigned int coalesceWindow;
+            ///Made by registerListener() for SERIAL listeners and shared by all of their calls
+            std::shared_ptr<Strand> strand;
+            ///The Event<Payload>::PayloadConverter of typed listeners, nullptr if they can not take replayed events
+            void (*fromLegacy)();
+            ///dispatchReplayed<Payload> of typed listeners with a fromLegacy converter
+            void (*dispatchReplay)(EventSource * es, const Listener & l, EventTypeID eventType, EventData * data, EventPriority priority, const std::shared_ptr<FlowGate> & gate);
+        };
+
+        ///Journal source ID given by setJournalName(), 0 until then
+        uint32_t journalSource;
+
+        ///Batches of coalescing listeners whose window is still open, keyed by the listener callback
+        std::unordered_map<void(*)(EventData *, std::atomic<bool> *), BatchEventData *> pendingBatches;
+
+        ///Locked when touching pendingBatches
+        std::mutex coalesceLock;
 
-        ///Unordered map is organized by event types, vectors contain pairs consisting of handler ID and handler function pointer
-        std::unordered_map<std::string, std::vector<std::pair<unsigned long, void(*)(EventData *, std::atomic<bool> *)>>> handlers;
+        ///\brief The listeners of one event type
+        struct EventEntry {
+            std::vector<Listener> listeners;
+            ///Set by setFlowControl(), empty if the event type has no limits
+            std::shared_ptr<FlowGate> gate;
+        };
 
+        ///Indexed by EventTypeID
+        typedef std::vector<EventEntry> ListenerTable;
 
-        static void manageThreads(EventSource * es);
+        ///\brief The current listener table, never modified once published.
+        ///Only accessed through std::atomic_load() and std::atomic_store(). Triggers iterate over whichever version they loaded without locking,
+        ///while addListener(), unsetListener(), clearListeners() and setFlowControl() copy it, change the copy and publish that under threadManipulationLock.
+        std::shared_ptr<const ListenerTable> handlers;
 
-        /// Loop that cleans up exited event listeners.
-        std::thread managerThread;
+        ///Returns a copy of the current listener table with room for eventType, expects threadManipulationLock to be held
+        ListenerTable * copyHandlers(EventTypeID eventType);
+
+        ///Publishes a table made by copyHandlers(), expects threadManipulationLock to be held
+        void publishHandlers(ListenerTable * table);
+
+
+        ///Gives the listener an ID and publishes it in the listener table of eventType
+        unsigned long registerListener(EventTypeID eventType, Listener l);
+
+        ///Entry point of every triggered event listener that was not INLINE. Runs it, frees the record, lets the next call of its strand and the next queued listener of its gate in and counts it out of inFlight.
+        static void runRecord(QueuedListener * record);
+
+        ///Runs the typed listener with a copy of the payload as its policy asks for. The caller must have counted the listener into inFlight.
+        template<typename Payload>
+        void dispatchTyped(const Listener & l, EventTypeID eventType, const Payload & payload, EventPriority priority, const std::shared_ptr<FlowGate> & gate);
+
+        ///Triggers an event replayed by the EventJournal, like triggerEvents() but typed listeners are called too if they can convert the EventData
+        void replayEvent(EventTypeID eventType, EventData * arg);
+
+        ///Body of triggerEvents() and replayEvent()
+        void trigger(EventTypeID eventType, EventData * arg, bool replay);
+
+        ///Converts replayed EventData to the payload of the typed listener and dispatches it
+        template<typename Payload>
+        static void dispatchReplayed(EventSource * es, const Listener & l, EventTypeID eventType, EventData * data, EventPriority priority, const std::shared_ptr<FlowGate> & gate);
+
+        ///Hands the record to schedule() if its gate has a free in flight slot, otherwise queues it or applies the OverflowPolicy of the gate
+        void admit(QueuedListener * record);
+
+        ///Starts the record, or queues it behind the running call of its strand
+        void schedule(QueuedListener * record);
+
+        ///Hands the record to the thread its policy asks for
+        static void start(QueuedListener * record);
+
+        ///Called when a call of a SERIAL listener has finished, starts the next call waiting on the strand
+        static void releaseStrand(Strand * strand);
+
+        ///Frees a record that will never run, counts it out of inFlight and as dropped in EventStatistics
+        void discard(QueuedListener * record);
+
+        ///Called when a listener that went through the gate has finished, starts the next queued listener in its slot
+        void releaseGate(FlowGate * gate);
+
+        ///Runs the listener with the data as its policy asks for, in the given lane if it is pooled. The caller must have counted the listener into inFlight.
+        void dispatch(const Listener & l, EventTypeID eventType, const std::shared_ptr<EventData> & data, EventPriority priority, const std::shared_ptr<FlowGate> & gate);
+
+        ///Adds the event to the open batch of a coalescing listener, or opens a new batch and sets a timer to close it
+        void coalesce(const Listener & l, EventTypeID eventType, const std::shared_ptr<EventData> & data);
+
+        ///Called by the EventDispatcher timer when the coalescing window of the handler is over, dispatches its batch
+        void flushBatch(const Listener & l, EventTypeID eventType, EventPriority priority);
+
+        ///Called once a triggered event listener has returned
+        void handlerFinished();
 };
 
+template<typename Payload>
+unsigned long EventSource::addListener(const Event<Payload> & event, void (*handler)(const Payload &), DispatchPolicy policy) {
+	Listener l{};
+	l.handler = nullptr;
+	l.typedHandler = reinterpret_cast<void (*)()>(handler);
+	l.policy = policy;
+	l.coalesceWindow = 0;
+	l.fromLegacy = reinterpret_cast<void (*)()>(event.getPayloadConverter());
+	l.dispatchReplay = l.fromLegacy == nullptr ? nullptr : &EventSource::dispatchReplayed<Payload>;
+	return registerListener(event.getID(), l);
+}
+
+template<typename Payload>
+void EventSource::triggerEvents(const Event<Payload> & event, const Payload & payload) {
+	if(requestJoin) { // Only trigger if we are still running.
+		return;
+	}
+
+	EventTypeID eventType = event.getID();
+	std::shared_ptr<const ListenerTable> table = std::atomic_load(&handlers);
+	bool legacyListeners = false;
+	if(eventType < table->size()) {
+		const EventEntry & entry = (*table)[eventType];
+		EventPriority priority = EventTypes::getPriority(eventType);
+		for(const Listener & l : entry.listeners) {
+			if(l.typedHandler == nullptr) {
+				legacyListeners = true;
+				continue;
+			}
+			inFlight++;
+			dispatchTyped(l, eventType, payload, priority, entry.gate);
+		}
+	}
+
+	// Only build the EventData if somebody still wants it, triggering it also records it in the journal and publishes it on the bus
+	if(event.hasLegacyConverter() && (legacyListeners || (EventJournal::isRecording() && listenerDepth == 0) || EventBus::isPublished(eventType))) {
+		triggerEvents(eventType, event.toEventData(payload));
+	}
+}
+
+template<typename Payload>
+void EventSource::dispatchTyped(const Listener & l, EventTypeID eventType, const Payload & payload, EventPriority priority, const std::shared_ptr<FlowGate> & gate) {
+	void (*handler)(const Payload &) = reinterpret_cast<void (*)(const Payload &)>(l.typedHandler);
+	EventStatistics::recordTrigger(eventType, l.id);
+	if(l.policy == DispatchPolicy::INLINE) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		{
+			ListenerScope scope;
+			handler(payload);
+		}
+		EventStatistics::recordRun(eventType, l.id, 0, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+		handlerFinished();
+		return;
+	}
+
+	TypedDispatchRecord<Payload> * record = new TypedDispatchRecord<Payload>(payload);
+	record->source = this;
+	record->handler = handler;
+	record->type = eventType;
+	record->listener = l.id;
+	record->policy = l.policy;
+	record->priority = priority;
+	record->triggeredAt = std::chrono::steady_clock::now();
+	record->gate = gate;
+	record->strand = l.strand;
+	admit(record);
+}
+
+template<typename Payload>
+void EventSource::dispatchReplayed(EventSource * es, const Listener & l, EventTypeID eventType, EventData * data, EventPriority priority, const std::shared_ptr<FlowGate> & gate) {
+	Payload payload;
+	typename Event<Payload>::PayloadConverter convert = reinterpret_cast<typename Event<Payload>::PayloadConverter>(l.fromLegacy);
+	if(!convert(data, payload)) {
+		es->handlerFinished();
+		return;
+	}
+	es->dispatchTyped(l, eventType, payload, priority, gate);
+}
+
 #endif // EVENTSOURCE_H
 
 /*! \page event-handling How Event Handling Works
-	\p Buckey makes use of the std::thread very often for asynchronous event handling. This is to allow for more fluid interaction with the user as multiple input, output, and computing processes can be running at once and not waiting for each to complete.
+	\p Buckey makes use of threads very often for asynchronous event handling. This is to allow for more fluid interaction with the user as multiple input, output, and computing processes can be running at once and not waiting for each to complete.
 	For example, I could ask Buckey to test my Internet download speed, which would take a minute or two for a reliable measurement. Imagine having to wait for two minutes until you can enter another command once the test is done.
 	Buckey provides a class for this, the EventSource class. If your object is going to trigger events, have it extend the EventSource class.
 	The EventSource class takes care of its own threads and memory management, so you do not have to worry about specialized constructors or destructors.
+	Triggered event listeners are ran on the worker threads of the shared EventDispatcher rather than on a new std::thread each. The number of workers is set with the event-workers key in buckey.yaml, setting it to 0 goes back to one std::thread per listener.
+	Pooled listeners are queued in the EventPriority lane of their event type. Speech and hypothesis events are REALTIME, output and prompt events are INTERACTIVE, and registry and lifecycle events are BACKGROUND, workers always drain the higher lanes first.
+	The event-deadlines key in buckey.yaml sets how many milliseconds a listener of each lane (realtime, interactive, background) may wait before it is counted as a deadline miss, 0 turns the deadline off.
 
 	\section event-conventions Event Listener Conventions
 	\p When creating Modes and Services, it is recommended that:
@@ -84,24 +432,59 @@ class EventSource
 	\li Store your event handler IDs in protected static fields.
 	\li If using the onModeEnable/Disable/Register, onServiceEnable/Disable/Register event listeners, it might be best to wait to register your event listeners once the Buckey::onInitFinishedEvent is triggered.
 	\li Make your event handlers do short synchronous tasks. If their task will take a while to run, then spin up another std::thread, or have it periodically check that Buckey has not been killed.
+	\li Register handlers that only copy a value or flip a flag with DispatchPolicy::INLINE, and handlers that block for a long time with DispatchPolicy::DEDICATED, so neither ties up a pool worker.
+	\li Register handlers that must see their events in order, or must not run alongside themselves, with DispatchPolicy::SERIAL instead of waiting on a flag. Each SERIAL listener gets its own queue, so it only holds up its own later calls.
 	\li When naming your event types, it is recommended that you start with "on" and end with "Event", for example: "onMyCustomEvent"
 	\li When naming your event handlers, it is recommended that you start with the event type and end with "Handler", for example: "onMyCustomEventHandler"
 	\li When naming the event handler IDs, it is recommended that you name them the same as your event handler method, but with "ID" on the end, example: "onMyCustomEventHandlerID"
 
+	\subsection event-type-ids Event Type IDs
+	\p Every event type is identified by a small integer EventTypeID. The event types built into Buckey have compile time IDs, named after their string macro with an _ID suffix (ONOUTPUT_ID, ON_HYPOTHESIS_ID, ...), see EventTypes.h.
+	Each EventSource keeps its listeners in a flat array indexed by EventTypeID, so triggering an event does not hash or compare any strings.
+	Custom event types can keep using plain strings, those are resolved to an ID through EventTypes::intern() on every call. To skip that, intern the name once and hold on to the ID.
+
 	\subsection triggering-event Triggering EventSource Events
-	\p To trigger an event from your object, call the void triggerEvents(std::string type, EventData * data) method.
-	The type string is the type of event that will be triggered. Listeners must be listening for this exact string. The EventData class is a generic class to hold data for events.
+	\p To trigger an event from your object, call the void triggerEvents(EventTypeID type, EventData * data) method, or its std::string overload for custom event types.
+	The type is the type of event that will be triggered. Listeners must be listening for this exact type. The EventData class is a generic class to hold data for events.
 	Many times it is extended to hold data for a specific purpose, however if you do not want to pass any data, it is advisable to create a new EventData object and leave it blank.
-	Do not worry about deleting your EventData object that you have allocated, it is internally deleted once all triggered event listeners have exited.
+	Do not worry about deleting your EventData object that you have allocated, all of the listeners of a trigger share ownership of it and it is deleted once the last of them has returned (or right away if nobody is listening).
+	Listeners must not keep the EventData pointer after they return. The EventData classes used by Buckey are allocated from per-type ObjectPools, so triggering them does not hit the global heap once the pools are warm.
 
 	\subsection registering-event-listeners Registering Event Listeners
-	\p To register an event handler with an object that extends the EventSource, call the public unsigned long addListener(std::string eventType, void (*)(EventData *, std::atomic<bool> *)) method.
-	The string eventType argument should be the same string that is used when triggering the event.
+	\p To register an event handler with an object that extends the EventSource, call the public unsigned long addListener(EventTypeID eventType, void (*)(EventData *, std::atomic<bool> *)) method.
+	The eventType argument should be the same ID (or string) that is used when triggering the event.
 	The void (*)(EventData *, std::atomic<bool> *) argument that accepts a pointer to a method that requires EventData * and std::atomic<booL> * as arguments and returns void. This function must be statically accessible.
+	An optional third argument sets the DispatchPolicy of the listener. INLINE listeners are called directly by triggerEvents() on the triggering thread, which costs about as much as a function call, but they hold up whoever triggered the event, so they must not block or take locks held by the trigger.
 	The addListener method returns a ULONG (unsigned long) data type. This is the ID of your event listener. <b> Store this event listener ID. You will need it when you go to unset your event listener.</b>
 
+	\subsection typed-events Typed Events
+	\p Events can also be described by an Event<Payload>, where the Payload is a plain struct, for example OutputEvent and OutputMessage in OutputEvent.h.
+	Typed listeners are registered with addListener(const Event<Payload> &, void (*)(const Payload &)) and get a const reference to their own copy of the payload, with no casting and no done flag.
+	A typed event is triggered with triggerEvents(event, payload). The payload is copied into the dispatch record of each listener, which comes from an ObjectPool, so nothing else is allocated per listener.
+	Listeners that still take EventData keep working: if the Event was given a converter, they are called with the EventData it builds, which is only built when such a listener exists.
+
+	\subsection flow-control Flow Control
+	\p By default every trigger hands every listener to the EventDispatcher straight away. setFlowControl() caps how many listeners of one event type may be handed over at once (maxInFlight) and how many may wait behind them (maxQueued).
+	Once both are used up the OverflowPolicy of the event type decides: BLOCK makes the triggering thread wait, DROP_OLDEST and DROP_NEWEST throw a listener away, and MERGE folds the event into a queued run of the same listener.
+	Only listeners that already take a BatchEventData, coalescing ones and typed ones that keep the latest payload, can be merged into. Every other listener is handled like DROP_OLDEST under MERGE, since it casts its EventData to its own type.
+	Every dropped, merged or blocked listener is counted, see getFlowStatistics() and describeFlowControl(). Buckey sets the limits of its own events from the event-limits key in buckey.yaml, and onOutputEvent gets 4 in flight and 32 queued with block if it is not listed, so replies and speech are held back rather than lost. Dropping them has to be asked for in event-limits.
+	Be careful with BLOCK on events that are triggered from inside a listener: a pool worker that blocks waits on listeners that may need that very worker to run, which can deadlock a small pool.
+
+	\subsection event-journal Recording and Replaying Events
+	\p Setting the event-journal key in buckey.yaml to a file name makes Buckey record every trigger of every EventSource to that file through the EventJournal, see EventJournal.h for the format.
+	Triggering only copies the serialized EventData into a ring buffer, a background thread writes it out. If the disk falls a whole ring behind, triggers are left out of the journal and counted as dropped in the event statistics.
+	Running buckey -r JOURNAL starts a Buckey with its Modes but no Services, sound, UNIX socket or console input (see Buckey::getReplayInstance()), triggers every recorded event again on the EventSource that recorded it (matched by the name given to setJournalName()) with the recorded timing, then prints the event statistics. buckey -R JOURNAL does the same as fast as it can.
+	EventData subclasses of your own should override EventData::serialize() and hand a decoder to EventJournal::setDecoder(), otherwise only the base EventData values are recorded. Typed events are recorded through their EventData converter, and only reach typed listeners on replay if the Event also has a converter back.
+	Only events triggered outside of a listener are recorded. Events a listener triggers are left out, since replaying the event that started the listener makes it trigger them again.
+
+	\subsection event-bus Following Events from Other Processes
+	\p The event types listed under events in the event-bus key of buckey.yaml are published into a ring of EVENT_BUS_SLOTS slots in the shared memory object named by its name key (/buckey-events by default).
+	Other processes on the machine follow it with an EventBusReader, which never makes a system call or writes to the ring after it is mapped, so readers can not slow Buckey down. buckey-subscribe is a small example that prints every published event.
+	Each slot holds the event type name and the EventData as written by EventData::serialize(). Payloads longer than EVENT_BUS_PAYLOAD_SIZE bytes are cut short and marked as truncated.
+	A reader that falls more than a whole ring behind skips to the oldest event still in the ring and counts the rest as missed. Only event types with an ID below 64 can be published, which covers all of the built in ones.
+
 	\subsection unsetting-event-listeners Removing/Unsetting Event Listeners
-	\p To stop listening for an event, call the public method void unsetListener(std::string eventType, unsigned long id).
+	\p To stop listening for an event, call the public method void unsetListener(EventTypeID eventType, unsigned long id).
 	NOTE: The event handler ID that you were passed will no longer be valid!
 
 	\subsection further-reading Further Reading/Refernces
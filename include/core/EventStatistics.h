@@ -0,0 +1,100 @@
+#ifndef EVENTSTATISTICS_H
+#define EVENTSTATISTICS_H
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <EventTypes.h>
+#include <LatencyHistogram.h>
+
+///\brief Records how often each event listener is triggered, how long it waits to be started and how long it runs.
+///
+///		Statistics are kept per event type and listener ID. Every thread records into a shard of its own, so the only lock taken while recording is the uncontended lock of that shard.
+///		Reading merges every shard. Shards of threads that have exited are merged into a retired total so their counts are not lost.
+class EventStatistics
+{
+	public:
+		///\brief The merged statistics of one event listener
+		struct Summary {
+			Summary();
+			EventTypeID type;
+			///ID returned by EventSource::addListener()
+			unsigned long listener;
+			///Times the listener was handed an event (or a batch of them)
+			unsigned long long triggered;
+			///Times the listener returned
+			unsigned long long finished;
+			///Times the listener was thrown away or merged into another run by flow control instead of being started
+			unsigned long long dropped;
+			///Sum of the time the listener waited between being triggered and being started, in microseconds
+			unsigned long long totalQueueMicros;
+			///Longest time the listener waited to be started, in microseconds
+			unsigned long long maxQueueMicros;
+			///How long the listener ran for
+			LatencyHistogram runTime;
+		};
+
+		///Counts a listener as triggered, called by the triggering thread
+		static void recordTrigger(EventTypeID type, unsigned long listener);
+
+		///Counts a listener as finished, called by the thread that ran it
+		static void recordRun(EventTypeID type, unsigned long listener, unsigned long long queueMicros, unsigned long long runMicros);
+
+		///Counts a triggered listener as dropped, called by the thread that threw it away
+		static void recordDrop(EventTypeID type, unsigned long listener);
+
+		///Merges every shard and appends one Summary per listener to out, sorted by event type and listener
+		static void collect(std::vector<Summary> & out);
+
+		///Returns a human readable report of every listener's statistics, along with the EventDispatcher's queue and deadline misses
+		static std::string report();
+
+	protected:
+		///Counters of one listener as seen by one thread
+		struct Counters {
+			Counters();
+			unsigned long long triggered;
+			unsigned long long finished;
+			unsigned long long dropped;
+			unsigned long long totalQueueMicros;
+			unsigned long long maxQueueMicros;
+			LatencyHistogram runTime;
+
+			///Adds every counter of other to this one
+			void merge(const Counters & other);
+		};
+
+		///Event type in the high 32 bits and listener ID in the low 32 bits
+		typedef unsigned long long Key;
+
+		///The counters recorded by one thread
+		struct Shard {
+			///Only ever contended by readers
+			std::mutex lock;
+			std::unordered_map<Key, Counters> counters;
+		};
+
+		///Creates the shard of the current thread when the thread first records, and retires it when the thread exits
+		struct ShardOwner {
+			ShardOwner();
+			~ShardOwner();
+			Shard * shard;
+		};
+
+		///Returns the shard of the calling thread
+		static Shard * localShard();
+
+		static Key makeKey(EventTypeID type, unsigned long listener);
+
+		///Locked when touching shards or retired
+		static std::mutex shardsLock;
+
+		///Shards of live threads
+		static std::vector<Shard *> shards;
+
+		///Counters of threads that have exited
+		static std::unordered_map<Key, Counters> retired;
+};
+
+#endif // EVENTSTATISTICS_H
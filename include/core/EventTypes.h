@@ -0,0 +1,131 @@
+#ifndef EVENTTYPES_H
+#define EVENTTYPES_H
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <EventPriority.h>
+
+///A small integer that identifies an event type, used by EventSources to index their listener lists directly
+typedef unsigned int EventTypeID;
+
+// String names of the events triggered by Buckey
+#define ONINPUT "onInputEvent"
+#define ONOUTPUT "onOutputEvent"
+
+#define ONCONVERSATIONSTART "onConversationStartEvent"
+#define ONCONVERSATIONEND "onConversationEndEvent"
+
+#define ONENTERPROMPT "onEnterPromptEvent"
+#define ONEXITPROMPT "onExitPromptEvent"
+
+#define ONMODEREGISTER "onModeRegisterEvent"
+#define ONMODEENABLE "onModeEnableEvent"
+#define ONMODEDISABLE "onModeDisableEvent"
+#define ONMODESTART "onModeStartEvent"
+#define ONMODESTOP "onModeStopEvent"
+
+#define ONSERVICEREGISTER "onServiceRegisterEvent"
+#define ONSERVICEENABLE "onServiceEnableEvent"
+#define ONSERVICEDISABLE "onServiceDisableEvent"
+#define ONSERVICESTOP "onServiceStopEvent"
+#define ONSERVICESTART "onServiceStartEvent"
+
+#define ONFINISHINIT "onFinishInitEvent"
+
+// String names of the events triggered by the SphinxService
+#define ON_START_SPEECH "onSpeechStart"
+#define ON_END_SPEECH "onSpeechEnd"
+#define ON_HYPOTHESIS "onHypothesis"
+#define ON_PAUSE "onPause"
+#define ON_RESUME "onResume"
+#define ON_READY "onReady"
+#define ON_SERVICE_READY "onServiceReady"
+
+// String names of the events triggered by TTSServices
+#define ON_SPEECH_START "onTTS_Start"
+#define ON_SPEECH_END "onTTS_End"
+
+// String names of the events triggered by the MimicTTSService
+#define ON_MIMIC_AUDIO_PREPARED "onMimicAudioPrepared"
+#define ASYNC_SPEECH_REQUEST "onAsyncSpeechRequest"
+
+///\brief Compile time IDs of the built in event types, each one matches the string macro of the same name without the _ID suffix.
+///
+///		These take up IDs 0 to BUILTIN_EVENT_TYPE_COUNT - 1. Custom event names are given the IDs after them by EventTypes::intern().
+enum BuiltinEventType : EventTypeID {
+	ONINPUT_ID,
+	ONOUTPUT_ID,
+	ONCONVERSATIONSTART_ID,
+	ONCONVERSATIONEND_ID,
+	ONENTERPROMPT_ID,
+	ONEXITPROMPT_ID,
+	ONMODEREGISTER_ID,
+	ONMODEENABLE_ID,
+	ONMODEDISABLE_ID,
+	ONMODESTART_ID,
+	ONMODESTOP_ID,
+	ONSERVICEREGISTER_ID,
+	ONSERVICEENABLE_ID,
+	ONSERVICEDISABLE_ID,
+	ONSERVICESTOP_ID,
+	ONSERVICESTART_ID,
+	ONFINISHINIT_ID,
+	ON_START_SPEECH_ID,
+	ON_END_SPEECH_ID,
+	ON_HYPOTHESIS_ID,
+	ON_PAUSE_ID,
+	ON_RESUME_ID,
+	ON_READY_ID,
+	ON_SERVICE_READY_ID,
+	ON_SPEECH_START_ID,
+	ON_SPEECH_END_ID,
+	ON_MIMIC_AUDIO_PREPARED_ID,
+	ASYNC_SPEECH_REQUEST_ID,
+	BUILTIN_EVENT_TYPE_COUNT
+};
+
+///\brief Maps event type names to EventTypeIDs and back.
+///
+///		The built in event types are registered up front under their BuiltinEventType IDs, any other name is given the next free ID the first time it is interned.
+///		IDs are never reused, so one interned ID stays valid for the life of the process.
+class EventTypes
+{
+	public:
+		///Returns the ID of the event type name, giving it a new ID if it has not been seen before
+		static EventTypeID intern(const std::string & name);
+
+		///Returns the name the ID was interned from, or an empty string for an unknown ID
+		static std::string getName(EventTypeID id);
+
+		///Returns the number of IDs handed out so far, every valid ID is below this
+		static EventTypeID count();
+
+		///Returns the lane listeners of the event type are queued in. Does not lock for the built in event types.
+		static EventPriority getPriority(EventTypeID id);
+
+		///\brief Sets the lane listeners of a custom event type are queued in, the built in event types keep their own.
+		///\return false if id is a built in event type or has not been handed out
+		static bool setPriority(EventTypeID id, EventPriority priority);
+
+	private:
+		///Locked when reading or writing ids and names
+		static std::mutex lock;
+
+		///Lazily fills ids and names with the built in event types, expects lock to be held
+		static void registerBuiltins();
+
+		static std::unordered_map<std::string, EventTypeID> ids;
+
+		///Indexed by ID
+		static std::vector<std::string> names;
+
+		///Lanes of the custom event types, indexed by ID - BUILTIN_EVENT_TYPE_COUNT
+		static std::vector<EventPriority> customPriorities;
+
+		///Lanes of the built in event types, indexed by ID
+		static const EventPriority builtinPriorities[BUILTIN_EVENT_TYPE_COUNT];
+};
+
+#endif // EVENTTYPES_H
@@ -0,0 +1,56 @@
+#ifndef FLOWCONTROL_H
+#define FLOWCONTROL_H
+#include <string>
+
+///\brief What an EventSource does with a triggered listener of an event type whose in flight and queue limits are both used up
+enum class OverflowPolicy
+{
+	///The triggering thread waits until a queued listener of the event type has started.
+	///A listener triggering from a worker of the EventDispatcher queues past the limit instead, the workers it would wait on could all be blocked the same way.
+	BLOCK,
+	///The listener that has been queued the longest is thrown away to make room
+	DROP_OLDEST,
+	///The listener that was just triggered is thrown away
+	DROP_NEWEST,
+	///The event is folded into the newest queued run of the same listener, coalescing listeners get one BatchEventData and typed listeners only keep the latest payload.
+	///Other EventData listeners expect their own EventData subclass and are never merged. If the listener can not be merged or has nothing queued, the oldest queued listener is dropped instead.
+	MERGE
+};
+
+///\brief Limits set on one event type of an EventSource with EventSource::setFlowControl()
+struct FlowControl
+{
+	FlowControl() : maxInFlight(0), maxQueued(0), overflow(OverflowPolicy::BLOCK) {}
+	FlowControl(unsigned int inFlight, unsigned int queued, OverflowPolicy policy) : maxInFlight(inFlight), maxQueued(queued), overflow(policy) {}
+
+	///Number of listeners of the event type that may be handed to the EventDispatcher at once, 0 turns flow control off
+	unsigned int maxInFlight;
+	///Number of listeners that may wait for one of the in flight slots
+	unsigned int maxQueued;
+	OverflowPolicy overflow;
+
+	///Returns the buckey.yaml name of the policy, "block", "drop-oldest", "drop-newest" or "merge"
+	static std::string getPolicyName(OverflowPolicy policy);
+
+	///Parses a buckey.yaml policy name, returns false and leaves policy alone if the name is unknown
+	static bool parsePolicy(const std::string & name, OverflowPolicy & policy);
+};
+
+///\brief Snapshot of the counters of one flow controlled event type, returned by EventSource::getFlowStatistics()
+struct FlowStatistics
+{
+	FlowStatistics() : running(0), queued(0), blocked(0), droppedOldest(0), droppedNewest(0), merged(0) {}
+
+	///Listeners currently handed to the EventDispatcher
+	unsigned int running;
+	///Listeners currently waiting for an in flight slot
+	unsigned int queued;
+	///Times a triggering thread had to wait under OverflowPolicy::BLOCK
+	unsigned long long blocked;
+	unsigned long long droppedOldest;
+	unsigned long long droppedNewest;
+	///Events folded into an already queued listener under OverflowPolicy::MERGE
+	unsigned long long merged;
+};
+
+#endif // FLOWCONTROL_H
@@ -0,0 +1,134 @@
+#ifndef GRAMMARMATCHER_H
+#define GRAMMARMATCHER_H
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include "grammar.h"
+#include "expansion.h"
+
+class Mode;
+class DynamicGrammar;
+
+///\brief Result of GrammarMatcher::match()
+struct GrammarMatch
+{
+	GrammarMatch() : matches(false), handle(nullptr) {}
+
+	bool matches;
+	///Name of the Mode whose rule matched
+	std::string mode;
+	///The Mode given to GrammarMatcher::compileMode(), so the match does not have to look it up by name
+	Mode * handle;
+	///Tags of the match in the order they appear in the rule, without the mode tag
+	std::vector<std::string> tags;
+};
+
+///\brief The rules of every Mode in the root grammar compiled into word level automata, so matching a command takes time linear in its number of words.
+///
+///		Every Mode rule is compiled on its own into a small program of word, split, jump and tag instructions, with its rule references inlined, and run as a Pike VM.
+///		Tags are emitted by instructions on the path the match took, so they come out of the match without walking the grammar again.
+///		The first word of a command picks the programs that can start with it, so adding Modes does not slow down matching the commands of other Modes.
+///		Modes are recompiled one at a time, when Buckey adds them again or when the generation of their DynamicGrammar moves because of setVariable().
+///		Words are compared lower cased, like the normalize stage of the InputPipeline leaves them. Recursive rules can not be compiled, isComplete() tells Buckey to fall back to Grammar::match().
+class GrammarMatcher
+{
+	public:
+		GrammarMatcher();
+
+		///Sets the words every command starts with before the Mode rule, like "buckey"
+		void setPrefix(const std::string & words);
+
+		///\brief Compiles the rule of the given name in root as the program of a Mode, replacing any earlier program of it
+		///\param source The DynamicGrammar of the Mode, recompiled by refresh() when its generation moves. May be nullptr.
+		///\param handle Handed back in GrammarMatch::handle when the Mode matches. May be nullptr.
+		///\return false if the rule could not be compiled, the Mode is kept so isComplete() returns false
+		bool compileMode(const std::string & mode, Grammar & root, const DynamicGrammar * source, Mode * handle = nullptr);
+
+		///Forgets the program of a Mode
+		void removeMode(const std::string & mode);
+
+		///Recompiles the Modes whose DynamicGrammar was changed since they were compiled, returns the number of Modes recompiled
+		unsigned int refresh(Grammar & root);
+
+		///Returns true if the rule of every Mode could be compiled
+		bool isComplete() const;
+
+		///Matches a whole command against the programs of every Mode, earlier added Modes win if several match
+		GrammarMatch match(const std::string & command) const;
+
+		///Returns the number of times a Mode was compiled, including recompiles
+		unsigned long long getCompileCount() const;
+
+		///Returns the number of Modes and the total number of instructions of their programs
+		std::size_t getModeCount() const;
+		std::size_t getInstructionCount() const;
+
+	protected:
+		enum class Op : uint8_t {
+			///Consumes the next word if its ID is x
+			WORD,
+			///Continues at x, and with lower priority at y
+			SPLIT,
+			JUMP,
+			///Adds tag x to the thread
+			TAG,
+			MATCH
+		};
+
+		struct Instruction {
+			Op op;
+			int x;
+			int y;
+		};
+
+		///The compiled rule of one Mode
+		struct Program {
+			std::string mode;
+			Mode * handle;
+			std::vector<Instruction> code;
+			///IDs of the words a command for this Mode can start with
+			std::vector<int> firstWords;
+			///True if the rule also matches nothing at all
+			bool matchesEmpty;
+			bool compiled;
+			const DynamicGrammar * source;
+			unsigned long generation;
+		};
+
+		///Appends the instructions of the expansion to code, rules is the stack of rules being inlined. Returns false if it can not be compiled.
+		bool compile(const Expansion * e, Grammar & root, std::vector<Instruction> & code, std::vector<std::string> & rules);
+
+		///Fills in firstWords and matchesEmpty of the program
+		void findFirstWords(Program & p) const;
+
+		///Rebuilds firstIndex after programs changed
+		void rebuildIndex();
+
+		///Follows the jumps, splits and tags from pc and appends the threads that end up on a WORD or MATCH to list, in priority order
+		void addThread(const Program & p, std::vector<std::pair<int, int>> & list, int pc, int history, std::vector<unsigned int> & seen, unsigned int stamp, std::vector<std::pair<int, int>> & tagHistory) const;
+
+		///Runs one program over the word IDs, fills in tags and returns true if it matched them all
+		bool run(const Program & p, const std::vector<int> & words, std::vector<std::string> & tags) const;
+
+		int internWord(const std::string & word);
+		int internTag(const std::string & tag);
+
+		///Lower cases and splits text on whitespace
+		static std::vector<std::string> splitWords(const std::string & text);
+
+		std::vector<int> prefix;
+		///In the order the Modes were first added
+		std::vector<Program> programs;
+		std::unordered_map<std::string, int> wordIDs;
+		std::unordered_map<std::string, int> tagIDs;
+		std::vector<std::string> tagNames;
+		///Programs that can start with each word ID, in priority order
+		std::unordered_map<int, std::vector<int>> firstIndex;
+		///Programs that match an empty command
+		std::vector<int> emptyPrograms;
+		unsigned long long compiles;
+};
+
+#endif // GRAMMARMATCHER_H
@@ -0,0 +1,167 @@
+#ifndef INPUTPIPELINE_H
+#define INPUTPIPELINE_H
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <functional>
+
+#include <BlockingQueue.h>
+#include <LatencyHistogram.h>
+
+class Mode;
+class TextFilter;
+
+///Default number of threads of an InputPipeline stage. One per stage keeps commands in the order they were submitted, the dispatch stage only queues them on the ModeExecutor of their Mode so it never waits on a Mode.
+#define DEFAULT_PIPELINE_WORKERS 1
+///Default number of commands that may wait in front of an InputPipeline stage before the stage before it waits too
+#define DEFAULT_PIPELINE_QUEUE 64
+
+//Sources of commands, see PipelineCommand::source
+#define INPUT_SOURCE_INTERNAL ""
+#define INPUT_SOURCE_CONSOLE "console"
+#define INPUT_SOURCE_SOCKET "socket"
+#define INPUT_SOURCE_SPEECH "speech"
+#define INPUT_SOURCE_BATCH "batch"
+
+///\brief The stages a command goes through in an InputPipeline, in order
+enum class PipelineStageType
+{
+	///Lower cases the command and turns punctuation and runs of whitespace into single spaces
+	NORMALIZE,
+	///Runs the command through every TextFilter given to InputPipeline::addFilter()
+	FILTER,
+	///Matches the command against the root grammar to find its Mode and tags
+	MATCH,
+	///Drops the command if it repeats one from the same source within the repeat window of its Mode
+	DEDUP,
+	///Hands the command to its Mode as it was passed in, with the tags of its match
+	DISPATCH
+};
+
+#define PIPELINE_STAGE_COUNT 5
+
+///\brief One command on its way through an InputPipeline
+struct PipelineCommand
+{
+	PipelineCommand() : target(nullptr) {}
+
+	///The command as it was passed in, this is what its Mode is given
+	std::string input;
+	///Where the command came from, one of the INPUT_SOURCE_ names or the name of a Service
+	std::string source;
+	///The command as the stages so far have rewritten it, used for matching, the MatchCache and dropping repeats
+	std::string text;
+	///Name of the Mode whose grammar it matched, set by the match stage
+	std::string mode;
+	///The Mode whose grammar it matched, set by the match stage. Modes are never deleted while Buckey runs, so it stays valid.
+	Mode * target;
+	///Tags of the grammar match, without the mode tag
+	std::vector<std::string> tags;
+	///When it entered the pipeline
+	std::chrono::steady_clock::time_point submitted;
+	///When it entered the queue of the stage it is in
+	std::chrono::steady_clock::time_point queued;
+	///Called once when the command leaves the pipeline, with true if it was dispatched and false if a stage dropped it or the pipeline stopped. May be empty.
+	std::function<void(const PipelineCommand &, bool)> done;
+};
+
+///\brief Worker and queue sizes of one InputPipeline stage
+struct PipelineStageConfig
+{
+	PipelineStageConfig() : workers(DEFAULT_PIPELINE_WORKERS), queue(DEFAULT_PIPELINE_QUEUE) {}
+	PipelineStageConfig(unsigned int w, std::size_t q) : workers(w), queue(q) {}
+
+	///More than one lets commands overtake each other in the stage, so "lights on" and "lights off" from the same source may reach their Mode the other way around
+	unsigned int workers;
+	///Most commands waiting for the stage before the stage in front of it waits, 0 for no limit
+	std::size_t queue;
+};
+
+///\brief Runs commands through normalizing, filtering, grammar matching, dropping repeats and Mode dispatch, each on its own threads with a bounded queue in front.
+///
+///		A command only holds up the stage it is in, so a Mode that takes a while does not stop the next command from being matched.
+///		With one worker per stage, the default, commands reach their Mode in the order they were submitted. Stages given more workers give up that order.
+///		When a stage falls behind its queue fills up and the stage before it waits, all the way back to submit(), rather than commands piling up without limit.
+///		Matching, dropping repeats and dispatching are done by the functions given to the constructor, returning false from any of them drops the command.
+class InputPipeline
+{
+	public:
+		///Function of a stage, returns false if the command should go no further
+		typedef std::function<bool(PipelineCommand &)> StageFunction;
+
+		InputPipeline(StageFunction match, StageFunction dedup, StageFunction dispatch);
+		///Stops the pipeline and deletes the filters given to it
+		virtual ~InputPipeline();
+
+		///Sets the workers and queue size of a stage, only has an effect before start()
+		void setStageConfig(PipelineStageType stage, const PipelineStageConfig & config);
+
+		///Adds a TextFilter to the end of the filter stage, the pipeline takes ownership of it. Only has an effect before start().
+		void addFilter(TextFilter * filter);
+
+		///Starts the worker threads of every stage
+		void start();
+
+		///Stops taking commands, lets every stage finish what it is working on and joins the workers. Queued commands are dropped.
+		void stop();
+
+		///\brief Enters a command into the pipeline, waiting if the first stage is full
+		///\param source Where the command came from, see PipelineCommand::source
+		///\param done Called once the command leaves the pipeline, see PipelineCommand::done. Not called if this returns false.
+		///\return false if the pipeline is stopped
+		bool submit(const std::string & command, const std::string & source = INPUT_SOURCE_INTERNAL, const std::function<void(const PipelineCommand &, bool)> & done = nullptr);
+
+		///Returns a report of the queue depth, throughput and latencies of every stage
+		std::string report();
+
+		///Returns the command lower cased with punctuation and runs of whitespace turned into single spaces, the way the normalize stage does
+		static std::string normalize(const std::string & command);
+
+		///Returns the name of the stage used in report(), like "normalize"
+		static std::string getStageName(PipelineStageType stage);
+
+	protected:
+		struct Stage {
+			Stage() : queue(nullptr), processed(0), dropped(0) {}
+
+			PipelineStageType type;
+			PipelineStageConfig config;
+			StageFunction function;
+			BlockingQueue<PipelineCommand> * queue;
+			std::vector<std::thread> workers;
+
+			///Locked when touching the counters and histograms below
+			std::mutex statisticsLock;
+			unsigned long long processed;
+			unsigned long long dropped;
+			///Time commands spent in the queue of the stage
+			LatencyHistogram waited;
+			///Time the stage function took
+			LatencyHistogram ran;
+		};
+
+		///Body of every worker thread
+		static void runWorker(InputPipeline * p, Stage * s);
+
+		///Stage function of the filter stage
+		bool filter(PipelineCommand & command);
+
+		///Calls the done function of a command that is leaving the pipeline, if it has one
+		static void finish(const PipelineCommand & command, bool dispatched);
+
+		Stage stages[PIPELINE_STAGE_COUNT];
+		std::vector<TextFilter *> filters;
+		///Time from submit() until the command was dispatched, locked with the statisticsLock of the dispatch stage
+		LatencyHistogram total;
+
+		///Locked by start() and stop()
+		std::mutex stateLock;
+		///Set if stop() was called by one of the workers, which then could not be joined
+		bool detached;
+		std::atomic<bool> running;
+};
+
+#endif // INPUTPIPELINE_H
@@ -0,0 +1,50 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+#include <string>
+
+///Number of powers of two of microseconds a LatencyHistogram covers, anything longer is counted in the last bucket
+#define LATENCY_HISTOGRAM_EXPONENTS 40
+///Number of linear sub-buckets every power of two is split into, keeps the error of any recorded value under 12.5%
+#define LATENCY_HISTOGRAM_SUB_BUCKETS 8
+#define LATENCY_HISTOGRAM_BUCKETS ((LATENCY_HISTOGRAM_EXPONENTS - 2) * LATENCY_HISTOGRAM_SUB_BUCKETS)
+
+///\brief A fixed size HDR style histogram of durations in microseconds.
+///
+///		Buckets grow exponentially with linear sub-buckets, so recording is a couple of shifts and an increment no matter the value.
+///		It is not thread safe, EventStatistics keeps one per thread and merges them when read.
+class LatencyHistogram
+{
+	public:
+		LatencyHistogram();
+
+		///Counts one duration of the given number of microseconds
+		void record(unsigned long long micros);
+
+		///Adds every count of other to this histogram
+		void merge(const LatencyHistogram & other);
+
+		///Returns the number of recorded durations
+		unsigned long long count() const;
+
+		///Returns the longest recorded duration in microseconds
+		unsigned long long max() const;
+
+		///Returns the upper bound of the bucket that holds the given percentile (0 to 100) of the recorded durations, in microseconds
+		unsigned long long percentile(double p) const;
+
+		///Formats a number of microseconds as a short human readable string, like 850us, 12.3ms or 2.1s
+		static std::string formatMicros(unsigned long long micros);
+
+	protected:
+		///Returns the bucket the duration is counted in
+		static unsigned int bucketOf(unsigned long long micros);
+
+		///Returns the largest duration counted in the bucket
+		static unsigned long long upperBoundOf(unsigned int bucket);
+
+		unsigned long long buckets[LATENCY_HISTOGRAM_BUCKETS];
+		unsigned long long total;
+		unsigned long long longest;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,61 @@
+#ifndef MATCHCACHE_H
+#define MATCHCACHE_H
+#include <list>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <unordered_map>
+
+#include "GrammarMatcher.h"
+
+///Default number of commands a MatchCache remembers, set with match-cache in buckey.yaml
+#define DEFAULT_MATCH_CACHE_SIZE 128
+
+///\brief Remembers the Mode and tags the most recently used commands matched, so a repeated command skips grammar matching.
+///
+///		Commands are looked up by their text after the normalize and filter stages of the InputPipeline.
+///		Every entry belongs to a generation of the root grammar, Buckey moves the generation whenever a Mode rule or variable changes and the whole cache is dropped the next time it is used.
+///		Only matching commands are remembered, a command that did not match is matched again in case it was a typo the user is about to fix with a new Mode.
+class MatchCache
+{
+	public:
+		///\param capacity Most commands remembered before the least recently used is dropped, 0 turns the cache off
+		MatchCache(std::size_t capacity = DEFAULT_MATCH_CACHE_SIZE);
+
+		///Sets the most commands remembered, dropping the least recently used ones past it
+		void setCapacity(std::size_t capacity);
+		std::size_t getCapacity();
+
+		///\brief Looks up a command matched under the given root grammar generation
+		///\return true and fills in result if the command is cached
+		bool lookup(const std::string & command, unsigned long generation, GrammarMatch & result);
+
+		///Remembers the match of a command under the given root grammar generation, ignored if the cache has already seen a later generation
+		void store(const std::string & command, unsigned long generation, const GrammarMatch & result);
+
+		///Returns a one line report of the size, hits, misses and invalidations of the cache
+		std::string report();
+
+	protected:
+		///Drops every entry if generation is newer than the one they belong to, returns false if it is older. Must be called with cacheLock locked.
+		bool moveToGeneration(unsigned long generation);
+
+		///Drops least recently used entries until there are at most capacity left. Must be called with cacheLock locked.
+		void trim();
+
+		typedef std::list<std::pair<std::string, GrammarMatch>> EntryList;
+
+		std::mutex cacheLock;
+		std::size_t capacity;
+		unsigned long generation;
+		///Most recently used first
+		EntryList entries;
+		std::unordered_map<std::string, EntryList::iterator> index;
+
+		unsigned long long hits;
+		unsigned long long misses;
+		///Number of times a new generation dropped the entries
+		unsigned long long invalidations;
+};
+
+#endif // MATCHCACHE_H
@@ -57,7 +57,8 @@ class Mode
 
 		//Input
 		/**
-		  * Called by Buckey::passCommand when the input matches this Mode's grammar.
+		  * Called when the input matches this Mode's grammar, on a thread of the ModeExecutor Buckey gives every registered Mode.
+		  * Modes that may take a while should return early once ModeExecutor::isCancelled() is true.
 		  * \param command [in] The command that was entered by the user
 		  * \param tags [in] A vector of matching tags from the root grammar
 		  */
@@ -76,7 +77,10 @@ class Mode
 		virtual void stop() = 0;
 
 		///Returns the name of the Mode
-		std::string getName() const;
+		const std::string & getName() const;
+
+		///Returns the milliseconds in which Buckey drops a repeat of a command for this Mode from the same source, 0 if repeats are passed on. See CommandDebouncer.
+		unsigned int getRepeatWindow() const;
 
 	protected:
 		///Sets the ModeState of this mode to the specified state.
@@ -93,6 +97,9 @@ class Mode
 
 		///The name of this mode
 		std::string name;
+
+		///Returned by getRepeatWindow(), set it in the constructor. 0 unless set.
+		unsigned int repeatWindow;
 };
 
 #endif // MODE_H
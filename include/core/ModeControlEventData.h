@@ -1,5 +1,6 @@
 #ifndef MODECONTROLEVENTDATA_H
 #define MODECONTROLEVENTDATA_H
+#include <cstddef>
 
 #include <EventData.h>
 #include <Mode.h>
@@ -14,6 +15,13 @@ class ModeControlEventData : public EventData
 		///\param mode [in] Pointer to the Mode that is considered to have triggered this event.
 		ModeControlEventData(Mode * m);
 		virtual ~ModeControlEventData();
+		///Allocates ModeControlEventData objects from a per-type ObjectPool so hot events do not hit the global heap
+		static void * operator new(std::size_t size);
+		///Returns the memory of a deleted ModeControlEventData to its ObjectPool
+		static void operator delete(void * p, std::size_t size);
+
+		///Writes the name of the Mode for the EventJournal, the replaying Buckey looks its own Mode up by that name
+		void serialize(PayloadWriter & out) const;
 		///\brief Returns a pointer to the Mode that triggered the event
 		///\return Pointer to the Mode that triggered the event
 		Mode * getMode();
@@ -0,0 +1,103 @@
+#ifndef MODEEXECUTOR_H
+#define MODEEXECUTOR_H
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <BlockingQueue.h>
+
+class Mode;
+
+///Default number of commands one Mode runs at once, 1 keeps Modes that were not written for it from being entered by several threads
+#define DEFAULT_MODE_CONCURRENCY 1
+///Default number of commands that may wait for a Mode before more are turned away
+#define DEFAULT_MODE_QUEUE 16
+
+///\brief Limits of the ModeExecutor of one Mode, set under mode-executors in buckey.yaml
+struct ModeExecutorConfig
+{
+	ModeExecutorConfig() : concurrency(DEFAULT_MODE_CONCURRENCY), queue(DEFAULT_MODE_QUEUE), timeout(0) {}
+
+	///Number of commands the Mode runs at once
+	unsigned int concurrency;
+	///Number of commands that may wait, commands past it are dropped
+	std::size_t queue;
+	///Milliseconds a command may wait and run for before it counts as cancelled, 0 for no limit
+	unsigned int timeout;
+};
+
+///\brief Runs the commands of one Mode on threads of its own, so a Mode that waits for the user or takes a while only holds up itself.
+///
+///		Modes can not be stopped in the middle of Mode::input(), cancelling a command and timeouts are cooperative:
+///		a Mode that may run for a while should check ModeExecutor::isCancelled() and return early once it is true.
+///		Commands that are cancelled or time out before they start are never passed to the Mode.
+class ModeExecutor
+{
+	public:
+		ModeExecutor(Mode * mode, const ModeExecutorConfig & config);
+		///Cancels every command and waits for the running ones to return
+		virtual ~ModeExecutor();
+
+		///\brief Queues the command for the Mode and returns without waiting for it to run
+		///\return false if the queue was full or the executor is stopping
+		bool submit(const std::string & command, const std::vector<std::string> & tags);
+
+		///Cancels every queued and running command of the Mode
+		void cancel();
+
+		///Returns true if the command the calling thread is running for its Mode was cancelled or ran past its timeout
+		static bool isCancelled();
+
+		///Returns a one line report of the running, queued, finished, cancelled and dropped commands
+		std::string report();
+
+		const ModeExecutorConfig & getConfig() const;
+
+	protected:
+		///Lets a Mode find out if its command should stop
+		struct CommandToken {
+			CommandToken() : cancelled(false), hasDeadline(false) {}
+
+			std::atomic<bool> cancelled;
+			bool hasDeadline;
+			std::chrono::steady_clock::time_point deadline;
+
+			bool isCancelled() const {
+				return cancelled.load() || (hasDeadline && std::chrono::steady_clock::now() > deadline);
+			}
+		};
+
+		struct ModeCommand {
+			std::string command;
+			std::vector<std::string> tags;
+			std::shared_ptr<CommandToken> token;
+		};
+
+		///Body of every worker thread
+		static void runWorker(ModeExecutor * e);
+
+		///Token of the command running on this thread, nullptr outside of a ModeExecutor
+		static thread_local CommandToken * current;
+
+		Mode * mode;
+		ModeExecutorConfig config;
+		BlockingQueue<ModeCommand> queue;
+		std::vector<std::thread> workers;
+
+		///Locked when touching running or the tokens of queued commands
+		std::mutex tokenLock;
+		///Tokens of every queued and running command, so cancel() can reach them
+		std::vector<std::shared_ptr<CommandToken>> tokens;
+
+		std::atomic<unsigned int> running;
+		std::atomic<unsigned long long> finished;
+		std::atomic<unsigned long long> cancelled;
+		std::atomic<unsigned long long> timedOut;
+		std::atomic<unsigned long long> dropped;
+};
+
+#endif // MODEEXECUTOR_H
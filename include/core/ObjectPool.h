@@ -0,0 +1,104 @@
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+#include <new>
+#include <mutex>
+#include <cstddef>
+
+///The most freed blocks an ObjectPool keeps around for reuse, anything freed past this is handed back to the global heap
+#define OBJECT_POOL_MAX_FREE 1024
+
+///\brief A per-type free list used to recycle the memory of frequently created objects.
+///
+///		Classes use it by declaring a class specific operator new and operator delete that call allocate() and release().
+///		Only blocks of exactly sizeof(T) are pooled, so a subclass that inherits the operators without declaring its own still works, it just goes to the global heap.
+template<typename T>
+class ObjectPool
+{
+	public:
+		///Returns a block of at least size bytes, reusing a previously released block when one is available
+		static void * allocate(std::size_t size) {
+			if(size == sizeof(T)) {
+				lock.lock();
+				FreeBlock * b = freeList;
+				if(b != nullptr) {
+					freeList = b->next;
+					freeCount--;
+				}
+				lock.unlock();
+				if(b != nullptr) {
+					return b;
+				}
+			}
+			return ::operator new(size < sizeof(FreeBlock) ? sizeof(FreeBlock) : size);
+		}
+
+		///Hands a block returned by allocate() back to the pool
+		static void release(void * p, std::size_t size) {
+			if(p == nullptr) {
+				return;
+			}
+			if(size == sizeof(T)) {
+				lock.lock();
+				if(freeCount < OBJECT_POOL_MAX_FREE) {
+					FreeBlock * b = static_cast<FreeBlock *>(p);
+					b->next = freeList;
+					freeList = b;
+					freeCount++;
+					lock.unlock();
+					return;
+				}
+				lock.unlock();
+			}
+			::operator delete(p);
+		}
+
+		///Returns the number of blocks waiting to be reused
+		static std::size_t available() {
+			lock.lock();
+			std::size_t c = freeCount;
+			lock.unlock();
+			return c;
+		}
+
+	private:
+		///A released block, reused as a node of the free list
+		struct FreeBlock {
+			FreeBlock * next;
+		};
+
+		static std::mutex lock;
+		static FreeBlock * freeList;
+		static std::size_t freeCount;
+};
+
+///\brief A standard allocator backed by ObjectPool, used for things like the control blocks of shared pointers.
+template<typename T>
+class ObjectPoolAllocator
+{
+	public:
+		typedef T value_type;
+
+		ObjectPoolAllocator() {}
+		template<typename U> ObjectPoolAllocator(const ObjectPoolAllocator<U> &) {}
+
+		T * allocate(std::size_t n) {
+			return static_cast<T *>(ObjectPool<T>::allocate(n * sizeof(T)));
+		}
+
+		void deallocate(T * p, std::size_t n) {
+			ObjectPool<T>::release(p, n * sizeof(T));
+		}
+
+		template<typename U> struct rebind {
+			typedef ObjectPoolAllocator<U> other;
+		};
+};
+
+template<typename T, typename U> bool operator==(const ObjectPoolAllocator<T> &, const ObjectPoolAllocator<U> &) { return true; }
+template<typename T, typename U> bool operator!=(const ObjectPoolAllocator<T> &, const ObjectPoolAllocator<U> &) { return false; }
+
+template<typename T> std::mutex ObjectPool<T>::lock;
+template<typename T> typename ObjectPool<T>::FreeBlock * ObjectPool<T>::freeList = nullptr;
+template<typename T> std::size_t ObjectPool<T>::freeCount = 0;
+
+#endif // OBJECTPOOL_H
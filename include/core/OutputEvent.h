@@ -0,0 +1,19 @@
+#ifndef OUTPUTEVENT_H
+#define OUTPUTEVENT_H
+#include <string>
+
+#include <Event.h>
+#include <ReplyType.h>
+
+///\brief Payload of the typed ONOUTPUT event, triggered by Buckey::reply()
+struct OutputMessage {
+	///The message that was outputted
+	std::string message;
+	///How the message was outputted
+	ReplyType type;
+};
+
+///The ONOUTPUT event, EventData listeners of ONOUTPUT are handed an OutputEventData
+extern const Event<OutputMessage> OutputEvent;
+
+#endif // OUTPUTEVENT_H
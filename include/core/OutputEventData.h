@@ -1,6 +1,7 @@
 #ifndef OUTPUTEVENTDATA_H
 #define OUTPUTEVENTDATA_H
 #include <string>
+#include <cstddef>
 
 #include <EventData.h>
 #include <ReplyType.h>
@@ -16,6 +17,15 @@ class OutputEventData : public EventData
 		///\param type [in] The ReplyType to store
 		OutputEventData(std::string message, ReplyType t);
 		virtual ~OutputEventData();
+		///Allocates OutputEventData objects from a per-type ObjectPool so hot events do not hit the global heap
+		static void * operator new(std::size_t size);
+		///Returns the memory of a deleted OutputEventData to its ObjectPool
+		static void operator delete(void * p, std::size_t size);
+
+		///Writes the message and ReplyType for the EventJournal
+		void serialize(PayloadWriter & out) const;
+		///EventJournal decoder of ONOUTPUT
+		static EventData * deserialize(PayloadReader & in);
 
 		///\brief Returns the message
 		///\return std::string The stored message that was outputted by Buckey
@@ -0,0 +1,40 @@
+#ifndef PAYLOADREADER_H
+#define PAYLOADREADER_H
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+///\brief Reads values written by a PayloadWriter back out of a byte string, in the order they were written.
+///
+///		Reading past the end does not throw, it returns zero values and makes good() return false from then on.
+class PayloadReader
+{
+	public:
+		///Reads from the size bytes at data, which must outlive the reader
+		PayloadReader(const char * data, std::size_t size);
+
+		uint8_t readByte();
+		bool readBool();
+		int32_t readInt();
+		uint32_t readUInt32();
+		uint64_t readUInt64();
+		std::string readString();
+
+		///Returns false if a read ran past the end of the bytes
+		bool good() const;
+
+		///Returns true if every byte has been read
+		bool atEnd() const;
+
+	protected:
+		///Returns true and advances if count more bytes can be read, otherwise marks the reader as failed
+		bool take(std::size_t count);
+
+		const char * data;
+		std::size_t size;
+		///Offset of the next byte to read
+		std::size_t position;
+		bool failed;
+};
+
+#endif // PAYLOADREADER_H
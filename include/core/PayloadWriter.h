@@ -0,0 +1,25 @@
+#ifndef PAYLOADWRITER_H
+#define PAYLOADWRITER_H
+#include <string>
+#include <cstdint>
+
+///\brief Appends values to a byte string in the little endian format of the EventJournal, read back by a PayloadReader in the same order.
+class PayloadWriter
+{
+	public:
+		///Appends to out, which must outlive the writer
+		PayloadWriter(std::string & out);
+
+		void writeByte(uint8_t b);
+		void writeBool(bool b);
+		void writeInt(int32_t i);
+		void writeUInt32(uint32_t i);
+		void writeUInt64(uint64_t i);
+		///Writes the length of the string followed by its bytes
+		void writeString(const std::string & s);
+
+	protected:
+		std::string & out;
+};
+
+#endif // PAYLOADWRITER_H
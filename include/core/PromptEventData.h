@@ -8,6 +8,11 @@ class PromptEventData : public EventData
 	public:
 		PromptEventData(std::string type);
 		std::string getType();
+
+		///Writes the prompt type for the EventJournal
+		void serialize(PayloadWriter & out) const;
+		///EventJournal decoder of ONENTERPROMPT
+		static EventData * deserialize(PayloadReader & in);
 		virtual ~PromptEventData();
 
 	protected:
@@ -0,0 +1,39 @@
+#ifndef ROOTGRAMMARSNAPSHOT_H
+#define ROOTGRAMMARSNAPSHOT_H
+#include <mutex>
+#include <memory>
+#include <string>
+
+#include "grammar.h"
+#include "GrammarMatcher.h"
+
+///\brief One version of the root grammar that never changes once made, so the match stage can use it without locking.
+///
+///		Buckey edits the root grammar and its GrammarMatcher under rootGrammarLock, then publishes a new snapshot holding a copy of the matcher and the text of the grammar.
+///		Readers keep the snapshot they took alive through its shared_ptr, so a Mode being added or removed while a command is matched can not change the rules under it.
+///		If the matcher could not compile every Mode the snapshot also parses its own copy of the grammar to match against, which only its readers lock.
+class RootGrammarSnapshot
+{
+	public:
+		///\param variableChanges DynamicGrammar::getChangeCount() from before matcher was refreshed
+		RootGrammarSnapshot(unsigned long generation, unsigned long variableChanges, const GrammarMatcher & matcher, const std::string & text);
+
+		///Matches a command against this version of the root grammar. If it does not match, tags holds the tags the fallback grammar got through.
+		GrammarMatch match(const std::string & command) const;
+
+		///Goes up every time Buckey changes the root grammar, see MatchCache
+		const unsigned long generation;
+		const unsigned long variableChanges;
+		///Text of the root grammar without the #JSGF header, as Grammar::getText() gives it
+		const std::string text;
+
+	protected:
+		const GrammarMatcher matcher;
+		const bool complete;
+		///Copy of the root grammar parsed from text, only made if matcher is not complete
+		std::unique_ptr<Grammar> fallback;
+		///Grammar::match() is not const, so readers of fallback take turns
+		mutable std::mutex fallbackLock;
+};
+
+#endif // ROOTGRAMMARSNAPSHOT_H
@@ -1,5 +1,6 @@
 #ifndef SERVICECONTROLEVENTDATA_H
 #define SERVICECONTROLEVENTDATA_H
+#include <cstddef>
 #include <EventData.h>
 #include <Service.h>
 
@@ -12,6 +13,13 @@ class ServiceControlEventData : public EventData
 	public:
 		ServiceControlEventData(Service * s);
 		virtual ~ServiceControlEventData();
+		///Allocates ServiceControlEventData objects from a per-type ObjectPool so hot events do not hit the global heap
+		static void * operator new(std::size_t size);
+		///Returns the memory of a deleted ServiceControlEventData to its ObjectPool
+		static void operator delete(void * p, std::size_t size);
+
+		///Writes the name of the Service for the EventJournal, the replaying Buckey looks its own Service up by that name
+		void serialize(PayloadWriter & out) const;
 
 		///Returns the stored Service pointer
 		Service * getService() const { return service; }
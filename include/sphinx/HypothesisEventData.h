@@ -1,6 +1,7 @@
 #ifndef HYPOTHESISEVENTDATA_H
 #define HYPOTHESISEVENTDATA_H
 #include <string>
+#include <cstddef>
 
 #include <core/EventData.h>
 
@@ -10,6 +11,15 @@ class HypothesisEventData : public EventData
     public:
         HypothesisEventData(std::string h = "");
         virtual ~HypothesisEventData();
+        ///Allocates HypothesisEventData objects from a per-type ObjectPool so hot events do not hit the global heap
+        static void * operator new(std::size_t size);
+        ///Returns the memory of a deleted HypothesisEventData to its ObjectPool
+        static void operator delete(void * p, std::size_t size);
+
+        ///Writes the hypothesis for the EventJournal
+        void serialize(PayloadWriter & out) const;
+        ///EventJournal decoder of ON_HYPOTHESIS
+        static EventData * deserialize(PayloadReader & in);
         ///Returns the stored hypothesis string
         std::string getHypothesis() const;
     protected:
@@ -1,7 +1,8 @@
 #ifndef SPHINXMODE_H
 #define SPHINXMODE_H
 
-#define TOGGLE_DEBOUNCE_TIME 250
+///Milliseconds in which a repeated command, like a toggle heard twice, is ignored
+#define SPHINX_REPEAT_WINDOW 250
 
 #include <Mode.h>
 #include <ServiceControlEventData.h>
@@ -45,9 +46,6 @@ class SphinxMode : public Mode
 		static unsigned long serviceEnableHandler;
 		static unsigned long serviceDisableHandler;
 		static unsigned long serviceRegisterHandler;
-
-		///Timestamp of when the most recent toggle speech recognition command was processed.
-		static std::chrono::high_resolution_clock::time_point lastToggleTimePoint;
 };
 
 #endif // SPHINXMODE_H
@@ -25,14 +25,7 @@
 
 #define AUDIO_FRAME_SIZE 2048
 
-// String constants for events implemented by the recognizer
-#define ON_START_SPEECH "onSpeechStart"
-#define ON_END_SPEECH "onSpeechEnd"
-#define ON_HYPOTHESIS "onHypothesis"
-#define ON_PAUSE "onPause"
-#define ON_RESUME "onResume"
-#define ON_READY "onReady"
-#define ON_SERVICE_READY "onServiceReady"
+// The names and EventTypeIDs of the events implemented by the recognizer (ON_HYPOTHESIS, ON_HYPOTHESIS_ID, ...) are defined in EventTypes.h
 
 class SphinxService : public Service, public EventSource
 {
@@ -124,6 +117,7 @@ class SphinxService : public Service, public EventSource
 		void updateSearchMode(SphinxHelper::SearchMode mode);
 		void updateLogPath(std::string pathToLog);
 		void setJSGF(Grammar * g);
+		void setJSGF(const std::string & grammarText);
         void applyUpdates();
 
         //Event handling
@@ -141,6 +135,9 @@ class SphinxService : public Service, public EventSource
         void clearOnPauseListeners();
         void clearOnResumeListeners();
 
+        ///Returns confirm.gram in the assets of the service, the grammar listened for while prompting and that Buckey matches the answers against. Writes CONFIRM_GRAMMAR to it first if it is missing.
+        cppfs::FileHandle getConfirmGrammarFile();
+
         static void onEnterPromptEventHandler(EventData * data, std::atomic<bool> * done);
 		static void onConversationEndEventHandler(EventData * data, std::atomic<bool> * done);
 
@@ -11,6 +11,9 @@ class AsyncSpeechRequestEventData : public EventData
 	public:
 		AsyncSpeechRequestEventData(std::string words, TTSService * service);
 		virtual ~AsyncSpeechRequestEventData();
+
+		///Writes the words for the EventJournal, the replaying TTS Service fills in tts itself
+		void serialize(PayloadWriter & out) const;
 		///Pointer to the TTS Service because event handlers are static
 		TTSService * tts;
 		///Words that are requested to be spoken
@@ -3,6 +3,7 @@
 #include <fstream>
 #include <ostream>
 #include <memory>
+#include <mutex>
 
 #include "mimic.h"
 #include "usenglish.h"
@@ -15,9 +16,9 @@
 #include <cppfs/FilePath.h>
 
 #include <TTSService.h>
+#include <OutputEvent.h>
 
-#define ON_MIMIC_AUDIO_PREPARED "onMimicAudioPrepared"
-#define ASYNC_SPEECH_REQUEST "onAsyncSpeechRequest"
+// The names and EventTypeIDs of ON_MIMIC_AUDIO_PREPARED and ASYNC_SPEECH_REQUEST are defined in EventTypes.h
 
 ///\brief An implementation of TTS Service using the Mimic-1 library.
 ///
@@ -83,7 +84,7 @@ class MimicTTSService : public TTSService
 		void addOnSpeechPrepared(void (*handler)(EventData *, std::atomic<bool> *));
 
 		///Event handler that is registered with Buckey and is passed any reply calls and speaks what should be spoken
-		static void handleOutputs(EventData * data, std::atomic<bool> * done);
+		static void handleOutputs(const OutputMessage & output);
 
 	protected:
 		///Create a new singleton instance if one does not exist already
@@ -93,9 +94,12 @@ class MimicTTSService : public TTSService
 		///Pointer to the singleton instance
 		static MimicTTSService * instance;
 
-		///Internal method that is made into a std::thread when speakAsync is called
+		///Internal method that is called in order on a serial executor when asyncSpeak is called
 		static void doAsyncRequest(EventData * data, std::atomic<bool> * done);
 
+		///EventJournal decoder of ASYNC_SPEECH_REQUEST, replayed requests are spoken by the running instance
+		static EventData * decodeAsyncRequest(PayloadReader & in);
+
 		///List of all prepared words and their respective filenames
 		std::vector<std::pair<std::string, std::string>> preparedAudio;
 		///The select voice
@@ -114,6 +118,9 @@ class MimicTTSService : public TTSService
 		///Event listener handle for the handleOutputs event listener
 		unsigned long onOutputHandle;
 
+		///Held while audio is playing, so overlapping speak() calls wait their turn instead of spinning on currentlySpeaking
+		std::mutex speechLock;
+
 	private:
 		int error;
 };
@@ -9,6 +9,11 @@ class SpeechPreparedEventData : public EventData
 		SpeechPreparedEventData();
 		SpeechPreparedEventData(std::string text, std::string fileName);
 		virtual ~SpeechPreparedEventData();
+
+		///Writes the words and file path for the EventJournal
+		void serialize(PayloadWriter & out) const;
+		///EventJournal decoder of ON_MIMIC_AUDIO_PREPARED
+		static EventData * deserialize(PayloadReader & in);
 		///The words that were prepared
 		const std::string words;
 
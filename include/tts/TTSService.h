@@ -6,8 +6,7 @@
 #include "Service.h"
 #include <EventSource.h>
 
-#define ON_SPEECH_START "onTTS_Start"
-#define ON_SPEECH_END "onTTS_End"
+// The names and EventTypeIDs of ON_SPEECH_START and ON_SPEECH_END are defined in EventTypes.h
 
 ///\brief Abstract class that should be extended and implemented by Services to provide TTS capability.
 class TTSService : public Service, public EventSource {
@@ -0,0 +1,144 @@
+#include "EventBus.h"
+
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+EventBus * EventBus::instance;
+std::atomic<bool> EventBus::instanceSet(false);
+std::mutex EventBus::instanceLock;
+std::atomic<uint64_t> EventBus::publishedTypes(0);
+
+EventBus * EventBus::getInstance() {
+	if(!instanceSet.load()) {
+		instanceLock.lock();
+		if(!instanceSet.load()) {
+			instance = new EventBus();
+			instanceSet.store(true);
+		}
+		instanceLock.unlock();
+	}
+	return instance;
+}
+
+EventBus::EventBus() : selectedTypes(0), header(nullptr), slots(nullptr)
+{
+
+}
+
+bool EventBus::open(const std::string & n) {
+	std::lock_guard<std::mutex> l(writeLock);
+	if(header != nullptr) {
+		return false;
+	}
+
+	int fd = shm_open(n.c_str(), O_CREAT | O_RDWR, 0644);
+	if(fd < 0) {
+		return false;
+	}
+	// Only ever grow the object, readers of a previous Buckey may still have it mapped and would fault on pages taken away
+	struct stat s;
+	if(fstat(fd, &s) < 0 || ((std::size_t) s.st_size < EVENT_BUS_SIZE && ftruncate(fd, EVENT_BUS_SIZE) < 0)) {
+		::close(fd);
+		return false;
+	}
+	void * memory = mmap(nullptr, EVENT_BUS_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd); // The mapping keeps the object alive
+	if(memory == MAP_FAILED) {
+		return false;
+	}
+
+	header = (EventBusHeader *) memory;
+	slots = (EventBusSlot *) ((char *) memory + sizeof(EventBusHeader));
+	// Readers still mapping the bus of a Buckey that died see it as closed while we reset it, then see the new epoch and start over
+	header->magic.store(0, std::memory_order_release);
+	uint64_t epoch = header->epoch.load(std::memory_order_relaxed) + 1;
+	for(unsigned int i = 0; i < EVENT_BUS_SLOTS; i++) {
+		slots[i].sequence.store(0, std::memory_order_relaxed);
+	}
+	header->version = EVENT_BUS_VERSION;
+	header->slotCount = EVENT_BUS_SLOTS;
+	header->slotSize = sizeof(EventBusSlot);
+	header->head.store(0);
+	header->writerPid = getpid();
+	header->epoch.store(epoch, std::memory_order_release);
+	header->magic.store(EVENT_BUS_MAGIC, std::memory_order_release);
+
+	name = n;
+	publishedTypes.store(selectedTypes.load());
+	return true;
+}
+
+void EventBus::close() {
+	publishedTypes.store(0);
+	std::lock_guard<std::mutex> l(writeLock);
+	if(header == nullptr) {
+		return;
+	}
+	header->magic.store(0, std::memory_order_release);
+	munmap(header, EVENT_BUS_SIZE);
+	shm_unlink(name.c_str());
+	header = nullptr;
+	slots = nullptr;
+	name = "";
+}
+
+bool EventBus::publish(EventTypeID type) {
+	if(type >= 64) {
+		return false;
+	}
+	std::lock_guard<std::mutex> l(writeLock);
+	typeNames[type] = EventTypes::getName(type);
+	selectedTypes |= ((uint64_t) 1) << type;
+	if(header != nullptr) {
+		publishedTypes.store(selectedTypes.load());
+	}
+	return true;
+}
+
+void EventBus::unpublish(EventTypeID type) {
+	if(type >= 64) {
+		return;
+	}
+	std::lock_guard<std::mutex> l(writeLock);
+	selectedTypes &= ~(((uint64_t) 1) << type);
+	if(header != nullptr) {
+		publishedTypes.store(selectedTypes.load());
+	}
+}
+
+void EventBus::write(EventTypeID type, const EventData * data) {
+	std::lock_guard<std::mutex> l(writeLock);
+	if(header == nullptr || type >= 64) { // Closed after the trigger checked isPublished()
+		return;
+	}
+
+	buffer.clear();
+	if(data != nullptr) {
+		PayloadWriter out(buffer);
+		data->serialize(out);
+	}
+
+	uint64_t position = header->head.load(std::memory_order_relaxed);
+	EventBusSlot & slot = slots[position & (EVENT_BUS_SLOTS - 1)];
+	slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release); // Readers that see any of the new data also see the odd sequence
+
+	slot.micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	strncpy(slot.type, typeNames[type].c_str(), EVENT_BUS_TYPE_SIZE - 1);
+	slot.type[EVENT_BUS_TYPE_SIZE - 1] = '\0';
+	slot.truncated = buffer.size() > EVENT_BUS_PAYLOAD_SIZE ? 1 : 0;
+	slot.length = slot.truncated ? EVENT_BUS_PAYLOAD_SIZE : buffer.size();
+	memcpy(slot.payload, buffer.data(), slot.length);
+
+	slot.sequence.store(2 * position + 2, std::memory_order_release);
+	header->head.store(position + 1, std::memory_order_release);
+}
+
+uint64_t EventBus::getPublished() {
+	std::lock_guard<std::mutex> l(writeLock);
+	return header == nullptr ? 0 : header->head.load();
+}
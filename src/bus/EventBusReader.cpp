@@ -0,0 +1,114 @@
+#include "EventBusReader.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+EventBusReader::EventBusReader() : header(nullptr), slots(nullptr), position(0), epoch(0), missed(0)
+{
+
+}
+
+EventBusReader::~EventBusReader()
+{
+	close();
+}
+
+bool EventBusReader::open(const std::string & name, bool fromOldest) {
+	close();
+
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if(fd < 0) {
+		return false;
+	}
+	struct stat s;
+	if(fstat(fd, &s) < 0 || (std::size_t) s.st_size < EVENT_BUS_SIZE) {
+		::close(fd);
+		return false;
+	}
+	void * memory = mmap(nullptr, EVENT_BUS_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(memory == MAP_FAILED) {
+		return false;
+	}
+
+	header = (const EventBusHeader *) memory;
+	slots = (const EventBusSlot *) ((const char *) memory + sizeof(EventBusHeader));
+	if(header->magic.load(std::memory_order_acquire) != EVENT_BUS_MAGIC || header->version != EVENT_BUS_VERSION
+			|| header->slotCount != EVENT_BUS_SLOTS || header->slotSize != sizeof(EventBusSlot)) {
+		close();
+		return false;
+	}
+
+	epoch = header->epoch.load(std::memory_order_acquire);
+	position = header->head.load(std::memory_order_acquire);
+	if(fromOldest) {
+		position = position > EVENT_BUS_SLOTS ? position - EVENT_BUS_SLOTS : 0;
+	}
+	missed = 0;
+	return true;
+}
+
+void EventBusReader::close() {
+	if(header != nullptr) {
+		munmap((void *) header, EVENT_BUS_SIZE);
+		header = nullptr;
+		slots = nullptr;
+	}
+}
+
+bool EventBusReader::isOpen() const {
+	return header != nullptr && header->magic.load(std::memory_order_acquire) == EVENT_BUS_MAGIC;
+}
+
+bool EventBusReader::next(EventBusMessage & message) {
+	while(isOpen()) {
+		uint64_t e = header->epoch.load(std::memory_order_acquire);
+		if(e != epoch) { // Another Buckey took the bus over, its messages count from 0 again
+			epoch = e;
+			position = 0;
+		}
+		uint64_t head = header->head.load(std::memory_order_acquire);
+		if(position >= head) {
+			return false;
+		}
+		if(head - position > EVENT_BUS_SLOTS) { // Lapped while we were away, skip to the oldest message still there
+			missed += head - EVENT_BUS_SLOTS - position;
+			position = head - EVENT_BUS_SLOTS;
+		}
+
+		const EventBusSlot & slot = slots[position & (EVENT_BUS_SLOTS - 1)];
+		uint64_t expected = 2 * position + 2;
+		uint64_t before = slot.sequence.load(std::memory_order_acquire);
+		if(before == expected) {
+			uint32_t length = slot.length;
+			if(length > EVENT_BUS_PAYLOAD_SIZE) {
+				length = EVENT_BUS_PAYLOAD_SIZE;
+			}
+			message.micros = slot.micros;
+			message.type.assign(slot.type, strnlen(slot.type, EVENT_BUS_TYPE_SIZE));
+			message.payload.assign(slot.payload, length);
+			message.truncated = slot.truncated != 0;
+			std::atomic_thread_fence(std::memory_order_acquire); // Make sure the copy is done before checking it was not overwritten meanwhile
+			if(slot.sequence.load(std::memory_order_relaxed) == expected && header->epoch.load(std::memory_order_relaxed) == epoch) {
+				message.sequence = position;
+				position++;
+				return true;
+			}
+		}
+		else if(before < expected) { // Claimed by head but not written yet, should not happen with a single writer
+			return false;
+		}
+
+		// Overwritten by a later lap, count it and move on
+		missed++;
+		position++;
+	}
+	return false;
+}
+
+uint64_t EventBusReader::getMissed() const {
+	return missed;
+}
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <csignal>
+
+#include "EventBusReader.h"
+#include "PayloadReader.h"
+
+///Example subscriber to Buckey's EventBus, prints every published event
+///Usage: buckey-subscribe [-a] [bus name]
+///	-a	Start with the oldest event still on the bus instead of the next new one
+
+using namespace std;
+
+#define IDLE_SLEEP_MS 1
+#define REOPEN_SLEEP_MS 500
+
+volatile sig_atomic_t running = 1;
+
+void stop(int) {
+	running = 0;
+}
+
+///Turns the payload into something readable, using what the built in event types are known to serialize
+string describe(const EventBusMessage & m) {
+	PayloadReader in(m.payload.data(), m.payload.size());
+	string text;
+	if(m.type == "onHypothesis") {
+		text = "\"" + in.readString() + "\"";
+	}
+	else if(m.type == "onOutputEvent") {
+		text = "\"" + in.readString() + "\"";
+		text += " reply type " + to_string(in.readInt());
+	}
+	else { // Plain EventData
+		bool b = in.readBool();
+		int i = in.readInt();
+		string s = in.readString();
+		text = "b=" + to_string(b) + " i=" + to_string(i) + " s=\"" + s + "\"";
+	}
+	if(!in.good() || !in.atEnd()) {
+		text = to_string(m.payload.size()) + " bytes";
+	}
+	if(m.truncated) {
+		text += " (truncated)";
+	}
+	return text;
+}
+
+int main(int argc, char * argv[]) {
+	string name = EVENT_BUS_NAME;
+	bool fromOldest = false;
+	for(int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if(arg == "-a") {
+			fromOldest = true;
+		}
+		else {
+			name = arg;
+		}
+	}
+	signal(SIGINT, stop);
+	signal(SIGTERM, stop);
+
+	EventBusReader reader;
+	EventBusMessage message;
+	uint64_t reportedMissed = 0;
+	while(running) {
+		if(!reader.isOpen()) {
+			if(!reader.open(name, fromOldest)) {
+				this_thread::sleep_for(chrono::milliseconds(REOPEN_SLEEP_MS));
+				continue;
+			}
+			cerr << "Subscribed to " << name << endl;
+			reportedMissed = 0;
+		}
+
+		if(!reader.next(message)) {
+			this_thread::sleep_for(chrono::milliseconds(IDLE_SLEEP_MS));
+			continue;
+		}
+		if(reader.getMissed() != reportedMissed) {
+			cerr << "Missed " << (reader.getMissed() - reportedMissed) << " events" << endl;
+			reportedMissed = reader.getMissed();
+		}
+		cout << message.sequence << " " << message.micros << " " << message.type << " " << describe(message) << endl;
+	}
+	reader.close();
+	return 0;
+}
@@ -0,0 +1,31 @@
+#include "BatchEventData.h"
+
+BatchEventData::BatchEventData()
+{
+
+}
+
+BatchEventData::~BatchEventData()
+{
+	//dtor
+}
+
+void BatchEventData::add(EventTypeID type, const std::shared_ptr<EventData> & data) {
+	events.push_back(std::pair<EventTypeID, std::shared_ptr<EventData>>(type, data));
+}
+
+void BatchEventData::append(const BatchEventData & other) {
+	events.insert(events.end(), other.events.begin(), other.events.end());
+}
+
+std::size_t BatchEventData::size() {
+	return events.size();
+}
+
+EventTypeID BatchEventData::getType(std::size_t index) {
+	return events[index].first;
+}
+
+EventData * BatchEventData::getEvent(std::size_t index) {
+	return events[index].second.get();
+}
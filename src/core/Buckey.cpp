@@ -3,9 +3,17 @@
 #include "SphinxService.h"
 #include "SphinxMode.h"
 #include "OutputEventData.h"
-#include "poll.h"
+#include "OutputEvent.h"
+#include "PromptEventData.h"
+#include "EventJournal.h"
+#include "EventBus.h"
+#include "filters/PerWordSingleReplacementFilter.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 #include <future>
+#include <sstream>
+#include <algorithm>
 #include <chrono>
 
 Buckey * Buckey::instance = nullptr;
@@ -15,7 +23,7 @@ std::mutex Buckey::logLock;
 FILE * Buckey::logFile;
 unsigned long Buckey::nextTempID = 0;
 
-Buckey::Buckey() : running(true), killed(false), inConversation(false), socketConnected(false)
+Buckey::Buckey() : running(true), killed(false), replaying(false), inConversation(false), prompting(0), confirmGrammar(nullptr), inputPipeline(nullptr), socketHandle(-1), socketWakeHandle(-1), rootGrammarGeneration(0)
 {
 	Buckey::logFile = fopen(LOG_FILE, "a");
 	logInfo("Buckey being constructed.");
@@ -25,7 +33,7 @@ Buckey::Buckey() : running(true), killed(false), inConversation(false), socketCo
     nextTempID = 0;
 }
 
-Buckey::Buckey(cppfs::FileHandle confDir, cppfs::FileHandle assetDir, cppfs::FileHandle tmpDir) : running(true), killed(false), inConversation(false), socketConnected(false)
+Buckey::Buckey(cppfs::FileHandle confDir, cppfs::FileHandle assetDir, cppfs::FileHandle tmpDir) : running(true), killed(false), replaying(false), inConversation(false), prompting(0), confirmGrammar(nullptr), inputPipeline(nullptr), socketHandle(-1), socketWakeHandle(-1), rootGrammarGeneration(0)
 {
 	Buckey::logFile = fopen(LOG_FILE, "a");
 	logInfo("Buckey being constructed.");
@@ -39,31 +47,44 @@ Buckey::~Buckey() {
 	requestStop();
 	logDebug("Received kill request. Deconstructing.");
 	killed.store(true);
+	wakeSocketManager();
 	inputWatcher.join();
-	//Stop listening on the unix socket
-	socketManagementThread.join();
-	close(socket2Handle);
-	close(socketHandle);
-
-	//Save enabled services
-	cppfs::FileHandle servicesEnabledList = coreConfigDir.open("services.enabled");
-	std::unique_ptr<std::ostream> o = servicesEnabledList.createOutputStream();
-	std::vector<std::string> enabledServices;
-	listEnabledServices(enabledServices);
-	for(std::string s : enabledServices) {
-		o->write((s+"\n").c_str(), s.length() + 1);
-	}
-	o->flush();
-
-	//Save enabled modes
-	cppfs::FileHandle modesEnabledList = coreConfigDir.open("modes.enabled");
-	o = modesEnabledList.createOutputStream();
-	std::vector<std::string> enabledModes;
-	listEnabledModes(enabledModes);
-	for(std::string s : enabledModes) {
-		o->write((s+"\n").c_str(), s.length() + 1);
+	//Let the Modes finish the commands they are running, commands still queued are dropped
+	delete inputPipeline;
+	inputPipeline = nullptr;
+	modeExecutorsLock.lock();
+	for(std::pair<const Mode * const, ModeExecutor *> & e : modeExecutors) {
+		delete e.second;
+	}
+	modeExecutors.clear();
+	modeExecutorsLock.unlock();
+	//Stop listening on the unix socket, a replaying Buckey never opened it
+	if(socketManagementThread.joinable()) {
+		socketManagementThread.join();
+		close(socketHandle);
+		close(socketWakeHandle);
+	}
+
+	//Save enabled services and modes, a replaying Buckey enabled no services so it would wipe the list
+	if(!replaying) {
+		cppfs::FileHandle servicesEnabledList = coreConfigDir.open("services.enabled");
+		std::unique_ptr<std::ostream> o = servicesEnabledList.createOutputStream();
+		std::vector<std::string> enabledServices;
+		listEnabledServices(enabledServices);
+		for(std::string s : enabledServices) {
+			o->write((s+"\n").c_str(), s.length() + 1);
+		}
+		o->flush();
+
+		cppfs::FileHandle modesEnabledList = coreConfigDir.open("modes.enabled");
+		o = modesEnabledList.createOutputStream();
+		std::vector<std::string> enabledModes;
+		listEnabledModes(enabledModes);
+		for(std::string s : enabledModes) {
+			o->write((s+"\n").c_str(), s.length() + 1);
+		}
+		o->flush();
 	}
-	o->flush();
 
 	//Stop all started Modes
 	for(unsigned int i = 0; i < modes.size(); i++) {
@@ -79,6 +100,10 @@ Buckey::~Buckey() {
 		}
 	}
 
+	//Write out whatever the event journal still holds
+	EventJournal::getInstance()->close();
+	EventBus::getInstance()->close();
+
 	//Sleep for a second to let loose threads close up
 	std::this_thread::sleep_for (std::chrono::seconds(1));
 
@@ -98,6 +123,7 @@ Buckey::~Buckey() {
 	}
 
 	delete rootGrammar;
+	delete confirmGrammar;
 
 	Mix_Quit();
 	SDL_CloseAudio();
@@ -146,37 +172,141 @@ void Buckey::init() {
 	coreAssetsDir = assetsDir.open("core");
 
     coreConfig = coreConfigDir.open("buckey.yaml");
+	coreConfigYAML = YAML::LoadFile(coreConfig.path());
+
+	//Size the event worker pool before registering anything, registering triggers the first events
+	if(coreConfigYAML["event-workers"]) {
+		if(!EventDispatcher::setWorkerCount(coreConfigYAML["event-workers"].as<unsigned int>())) {
+			logWarn("Event workers were already started, ignoring event-workers in buckey.yaml");
+		}
+	}
+	if(coreConfigYAML["event-deadlines"]) {
+		YAML::Node deadlines = coreConfigYAML["event-deadlines"];
+		if(deadlines["realtime"]) {
+			EventDispatcher::setDeadline(EventPriority::REALTIME, deadlines["realtime"].as<unsigned int>());
+		}
+		if(deadlines["interactive"]) {
+			EventDispatcher::setDeadline(EventPriority::INTERACTIVE, deadlines["interactive"].as<unsigned int>());
+		}
+		if(deadlines["background"]) {
+			EventDispatcher::setDeadline(EventPriority::BACKGROUND, deadlines["background"].as<unsigned int>());
+		}
+	}
+
+	setFlowControl(ONOUTPUT_ID, FlowControl(DEFAULT_OUTPUT_IN_FLIGHT, DEFAULT_OUTPUT_QUEUE, OverflowPolicy::BLOCK));
+	if(coreConfigYAML["event-limits"]) {
+		for(YAML::const_iterator i = coreConfigYAML["event-limits"].begin(); i != coreConfigYAML["event-limits"].end(); i++) {
+			std::string eventType = i->first.as<std::string>();
+			YAML::Node limits = i->second;
+			FlowControl f = getFlowControl(EventTypes::intern(eventType));
+			if(limits["in-flight"]) {
+				f.maxInFlight = limits["in-flight"].as<unsigned int>();
+			}
+			if(limits["queue"]) {
+				f.maxQueued = limits["queue"].as<unsigned int>();
+			}
+			if(limits["overflow"] && !FlowControl::parsePolicy(limits["overflow"].as<std::string>(), f.overflow)) {
+				logWarn("Unknown overflow policy " + limits["overflow"].as<std::string>() + " for " + eventType + " in buckey.yaml");
+			}
+			setFlowControl(eventType, f);
+		}
+	}
+
+	//Record every trigger to the event journal if one is configured, the decoders let a replaying Buckey rebuild them
+	setJournalName("buckey");
+	EventJournal * journal = EventJournal::getInstance();
+	journal->setDecoder(ONOUTPUT_ID, OutputEventData::deserialize);
+	journal->setDecoder(ONENTERPROMPT_ID, PromptEventData::deserialize);
+	journal->setDecoder(ONMODEREGISTER_ID, decodeModeControl);
+	journal->setDecoder(ONMODEENABLE_ID, decodeModeControl);
+	journal->setDecoder(ONMODEDISABLE_ID, decodeModeControl);
+	journal->setDecoder(ONMODESTART_ID, decodeModeControl);
+	journal->setDecoder(ONMODESTOP_ID, decodeModeControl);
+	journal->setDecoder(ONSERVICEREGISTER_ID, decodeServiceControl);
+	journal->setDecoder(ONSERVICEENABLE_ID, decodeServiceControl);
+	journal->setDecoder(ONSERVICEDISABLE_ID, decodeServiceControl);
+	journal->setDecoder(ONSERVICESTOP_ID, decodeServiceControl);
+	journal->setDecoder(ONSERVICESTART_ID, decodeServiceControl);
+	if(coreConfigYAML["event-journal"] && !journal->isReplayMode()) {
+		std::string journalPath = coreConfigYAML["event-journal"].as<std::string>();
+		if(journalPath != "") {
+			if(journal->open(journalPath)) {
+				logInfo("Recording events to " + journalPath);
+			}
+			else {
+				logWarn("Could not open event journal " + journalPath);
+			}
+		}
+	}
+
+	//Publish the selected events to other local processes through shared memory, replayed events are not live so they are kept off the bus
+	if(coreConfigYAML["event-bus"] && coreConfigYAML["event-bus"]["events"] && !replaying) {
+		YAML::Node busConfig = coreConfigYAML["event-bus"];
+		EventBus * bus = EventBus::getInstance();
+		for(YAML::const_iterator i = busConfig["events"].begin(); i != busConfig["events"].end(); i++) {
+			std::string eventType = i->as<std::string>();
+			if(!bus->publish(EventTypes::intern(eventType))) {
+				logWarn("Event " + eventType + " can not be published on the event bus");
+			}
+		}
+		std::string busName = busConfig["name"] ? busConfig["name"].as<std::string>() : EVENT_BUS_NAME;
+		if(bus->open(busName)) {
+			logInfo("Publishing events on " + busName);
+		}
+		else {
+			logWarn("Could not open event bus " + busName);
+		}
+	}
 
     //Set up the root grammar
     rootGrammar = new DynamicGrammar();
+
+	setupInputPipeline();
+	if(coreConfigYAML["match-cache"] && coreConfigYAML["match-cache"]["size"]) {
+		matchCache.setCapacity(coreConfigYAML["match-cache"]["size"].as<unsigned int>());
+	}
 	modeList.reset(new AlternativeSet());
 	rootExpansion.reset(new Sequence());
-	((Sequence *) rootExpansion.get())->addChild(shared_ptr<Token>(new Token("buckey")));
+	((Sequence *) rootExpansion.get())->addChild(shared_ptr<Token>(new Token(ROOT_COMMAND_PREFIX)));
+	rootMatcher.setPrefix(ROOT_COMMAND_PREFIX);
 	((Sequence *) rootExpansion.get())->addChild(modeList);
 	rootGrammar->addRule(shared_ptr<Rule>(new Rule("root", true, rootExpansion)));
+	rootGrammarLock.lock();
+	publishRootGrammar();
+	rootGrammarLock.unlock();
 
+	indexLock.lock();
 	services.clear();
 	modes.clear();
+	serviceIndex.clear();
+	modeIndex.clear();
+	indexLock.unlock();
 
 	registerAllServices();
 	registerAllModes();
+	loadConfirmGrammar();
 
 	readCoreConfig();
 
-	initAudio();
+	if(!replaying) {
+		initAudio();
+	}
 
 	//setlogmask(LOG_DEBUG);
 	enableMode("core");
 
 	//Set up the unix socket
 	//Start listening on the unix socket now that everything is ready
-    makeServerSocket();
-    socketManagementThread = std::thread(manageUnixSocket);
+	if(!replaying) {
+	    makeServerSocket();
+	    socketManagementThread = std::thread(manageUnixSocket);
+	}
 
     //Start watching the inputQue
+    inputPipeline->start();
     inputWatcher = std::thread(watchInputQue, this);
 
-    triggerEvents(ONFINISHINIT, new EventData());
+    triggerEvents(ONFINISHINIT_ID, new EventData());
 }
 
 ///Called in Buckey::init(), loads SDL_mixer, sets up callbacks, loads built in sound effects into soundBank.
@@ -235,11 +365,18 @@ bool Buckey::isMakingSound() {
 	return soundsPlayingCount.load() != 0;
 }
 
+bool Buckey::isReplaying() const {
+	return replaying;
+}
+
 unsigned short Buckey::countSoundsPlaying() {
 	return soundsPlayingCount.load();
 }
 
 bool Buckey::playSoundEffect(SoundEffects e, bool sync) {
+	if(replaying) { // Audio was never opened
+		return false;
+	}
 	Mix_Chunk * c;
     for(std::pair<SoundEffects, Mix_Chunk *> p : soundBank) {
 		if(p.first == e) {
@@ -282,16 +419,19 @@ void Buckey::soundEffectDoneCallback(int channel) {
 
 ///Called in Buckey::init(), enables the services and modes enabled in services.enabled and modes.enabled config files
 void Buckey::readCoreConfig() {
-	cppfs::FileHandle servicesEnabledList = coreConfigDir.open("services.enabled");
-	if(!servicesEnabledList.isFile()) {
-		servicesEnabledList.writeFile("mimic\nsphinx\n");
-	}
-	std::istream * i = servicesEnabledList.createInputStream().release();
 	char buff[60];
-	while(i->getline(buff, 60) && !i->eof()) {
-		enableService(buff);
+	std::istream * i;
+	if(!replaying) { // Services talk to the microphone and speakers, a replay has to stay off them
+		cppfs::FileHandle servicesEnabledList = coreConfigDir.open("services.enabled");
+		if(!servicesEnabledList.isFile()) {
+			servicesEnabledList.writeFile("mimic\nsphinx\n");
+		}
+		i = servicesEnabledList.createInputStream().release();
+		while(i->getline(buff, 60) && !i->eof()) {
+			enableService(buff);
+		}
+		delete i;
 	}
-	delete i;
 
 	cppfs::FileHandle modesEnabledList = coreConfigDir.open("modes.enabled");
 	if(!modesEnabledList.isFile()) {
@@ -304,8 +444,20 @@ void Buckey::readCoreConfig() {
 		enableMode(buff);
 	}
 	delete i;
+}
 
-	coreConfigYAML = YAML::LoadFile(coreConfig.path());
+///Parses the confirm.gram SphinxService listens with while prompting, so answers are matched against the grammar they were recognized with
+void Buckey::loadConfirmGrammar() {
+	cppfs::FileHandle confirmGram = SphinxService::getInstance()->getConfirmGrammarFile();
+	std::unique_ptr<std::istream> in = confirmGram.createInputStream();
+	if(in) {
+		confirmGrammar = new Grammar(*in);
+	}
+	else {
+		logWarn("Could not read " + confirmGram.path() + ", matching prompt answers against the built in confirm grammar");
+		std::istringstream confirmText(CONFIRM_GRAMMAR);
+		confirmGrammar = new Grammar(confirmText);
+	}
 }
 
 ///Registers all available services with Buckey, when adding in your own service, add it into this function if possible.
@@ -351,171 +503,482 @@ void Buckey::makeServerSocket() {
 	    exit(-1);
 	}
 
-	if(listen(socketHandle, 1) == -1) {
+	socketWakeHandle = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if(socketWakeHandle == -1) {
+		syslog(LOG_ERR, "Error creating eventfd for the unix socket!");
+		std::cout << "Error creating eventfd for the unix socket!" << std::endl;
+	    exit(-1);
+	}
+
+	if(listen(socketHandle, MAX_SOCKET_CLIENTS) == -1) {
 		syslog(LOG_ERR, "Error while requesting to listen to server unix socket!");
 		std::cout << "Error while requesting to listen to server unix socket!" << std::endl;
 	    exit(-1);
 	}
 }
 
-///Thread that listens for connections to the UNIX socket and reads input
+///Wakes manageUnixSocket() out of epoll_wait()
+void Buckey::wakeSocketManager() {
+	if(socketWakeHandle == -1) { // The socket was never made
+		return;
+	}
+	uint64_t wake = 1;
+	if(write(socketWakeHandle, &wake, sizeof(wake)) == -1 && errno != EAGAIN) { // EAGAIN means it is already woken
+		logError("Could not wake the unix socket manager!");
+	}
+}
+
+/**	\brief Thread that serves every client of the UNIX socket
+  *
+  * An epoll reactor, it sleeps until a client connects, sends something or hangs up, or wakeSocketManager() is called.
+  * Every connection has its own line buffer and batch, lines are handled in the order they came in.
+  * When a batch is full the lines after it are kept and the connection is no longer read, so the client waits on its socket instead of holding up the others.
+  * Output never waits either, what a connection has no room for stays in socketOutput and is written when epoll reports room with EPOLLOUT.
+  */
 void Buckey::manageUnixSocket() {
-	int currentReadSize = 0;
-	std::string s;
-	char readBuffer[SOCKET_BUFFER_SIZE];
-	unsigned int t = sizeof(remote);
 	Buckey * b = getInstance();
+	std::unordered_map<int, SocketClient> clients;
+	std::vector<CommandBatch *> orphans; // Batches of clients that left before ending them, deleted once their commands are done
+	char readBuffer[SOCKET_READ_SIZE];
+	struct epoll_event events[SOCKET_EVENTS];
+
+	int epollHandle = epoll_create1(EPOLL_CLOEXEC);
+	if(epollHandle == -1) {
+		syslog(LOG_ERR, "Error creating epoll instance for the unix socket!");
+		logError("Error creating epoll instance for the unix socket!");
+		return;
+	}
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.fd = b->socketHandle;
+	epoll_ctl(epollHandle, EPOLL_CTL_ADD, b->socketHandle, &event);
+	event.data.fd = b->socketWakeHandle;
+	epoll_ctl(epollHandle, EPOLL_CTL_ADD, b->socketWakeHandle, &event);
+
+	// Writes as much of the output waiting for a client as it has room for, a client that can not be written to any more is taken as hung up
+	auto flushClient = [&](int fd) {
+		SocketClient & c = clients[fd];
+		std::lock_guard<std::mutex> l(b->socketClientsLock);
+		std::string & out = b->socketOutput[fd];
+		size_t sent = 0;
+		while(sent < out.size()) {
+			ssize_t n = send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+			if(n >= 0) {
+				sent += n;
+			}
+			else if(errno != EINTR) {
+				break;
+			}
+		}
+		if(sent < out.size() && errno != EAGAIN && errno != EWOULDBLOCK) {
+			sent = out.size();
+			c.hungUp = true;
+		}
+		out.erase(0, sent);
+		c.writing = !out.empty();
+	};
+
+	// Answers go to the client that asked only, reply() would send them to everyone. They are never dropped, whatever does not fit is written later.
+	auto answer = [&](int fd, const std::string & text) {
+		b->socketClientsLock.lock();
+		b->socketOutput[fd] += text;
+		b->socketClientsLock.unlock();
+		flushClient(fd);
+	};
+
+	// Clients with an open batch are left out of reply() broadcasts, they would fill the socket before the report of the batch
+	auto setBroadcast = [b](int fd, bool broadcast) {
+		std::lock_guard<std::mutex> l(b->socketClientsLock);
+		b->socketClients.erase(std::remove(b->socketClients.begin(), b->socketClients.end(), fd), b->socketClients.end());
+		if(broadcast) {
+			b->socketClients.push_back(fd);
+		}
+	};
 
-	struct pollfd pollstruct;
-	pollstruct.fd = b->socketHandle;
-	pollstruct.events = POLLIN;
-
+	auto closeClient = [&](int fd) {
+		SocketClient & c = clients[fd];
+		if(c.batch != nullptr) {
+			orphans.push_back(c.batch);
+		}
+		if(c.watching != 0) {
+			epoll_ctl(epollHandle, EPOLL_CTL_DEL, fd, nullptr);
+		}
+		setBroadcast(fd, false);
+		b->socketClientsLock.lock();
+		b->socketOutput.erase(fd);
+		b->socketClientsLock.unlock();
+		close(fd);
+		clients.erase(fd);
+	};
+
+	// Closes the client once it hung up, every line is handled and its output is written, otherwise watches it for what it is waiting on
+	auto updateClient = [&](int fd) {
+		SocketClient & c = clients[fd];
+		if(c.lines.empty() && c.hungUp && !c.writing) {
+			closeClient(fd);
+			return;
+		}
+		unsigned int wanted = (c.lines.empty() && !c.hungUp ? EPOLLIN : 0) | (c.writing ? EPOLLOUT : 0);
+		if(wanted == c.watching) {
+			return;
+		}
+		struct epoll_event e;
+		e.events = wanted;
+		e.data.fd = fd;
+		epoll_ctl(epollHandle, c.watching == 0 ? EPOLL_CTL_ADD : (wanted == 0 ? EPOLL_CTL_DEL : EPOLL_CTL_MOD), fd, &e);
+		c.watching = wanted;
+	};
+
+	// Handles the lines of a client as far as it can
+	auto serveClient = [&](int fd) {
+		SocketClient & c = clients[fd];
+		while(!c.lines.empty()) {
+			const std::string & s = c.lines.front();
+			if(c.batch != nullptr) { // Every line up to ?end is a command of the batch
+				if(s == BATCH_END_QUERY "\n") {
+					if(!c.batch->isIdle()) {
+						break; // The room callback wakes us when its last command is done
+					}
+					std::string report = c.batch->report();
+					delete c.batch;
+					c.batch = nullptr;
+					logInfo("Finished command batch: " + report);
+					answer(fd, report);
+					setBroadcast(fd, true);
+				}
+				else if(c.batch->isFull()) {
+					break; // The room callback wakes us when a command is done
+				}
+				else if(!c.batch->submit(s)) {
+					logWarn("Input pipeline is stopped, dropping batch command " + s);
+				}
+			}
+			else if(s[0] == ':') {
+				std::string command = s;
+				command[0] = ' ';
+				b->passCommand(command, INPUT_SOURCE_SOCKET);
+			}
+			else if(s == "?stats\n") {
+				answer(fd, b->getEventStatistics());
+			}
+			else if(StringHelper::stringStartsWith(s, BATCH_QUERY) && (s[strlen(BATCH_QUERY)] == ' ' || s[strlen(BATCH_QUERY)] == '\n')) { // "?batch [concurrency]", the lines after it are commands until "?end"
+				const char * argument = s.c_str() + strlen(BATCH_QUERY);
+				char * end;
+				unsigned long concurrency = strtoul(argument, &end, 10);
+				c.batch = b->startCommandBatch(end == argument ? DEFAULT_BATCH_CONCURRENCY : concurrency); // CommandBatch takes 0 as 1
+				if(c.batch == nullptr) {
+					answer(fd, "Input pipeline is stopped\n");
+				}
+				else {
+					c.batch->setRoomCallback([b]() { b->wakeSocketManager(); });
+					setBroadcast(fd, false);
+				}
+			}
+			else {
+				b->passInput(s, INPUT_SOURCE_SOCKET);
+			}
+			c.lines.pop_front();
+		}
+		updateClient(fd);
+	};
 
 	while(!b->killed.load()) {
+		int count = epoll_wait(epollHandle, events, SOCKET_EVENTS, -1);
+		if(count == -1) {
+			if(errno == EINTR) {
+				continue;
+			}
+			syslog(LOG_ERR, "Error while waiting on the unix socket!");
+			logError("Error while waiting on the unix socket!");
+			break;
+		}
 
-		if(poll(&pollstruct, 1, 500) > 0) {
-			s = "";
-			if ((b->socket2Handle = accept(b->socketHandle, (struct sockaddr *)&(b->remote), &t)) == -1) {
-				if(errno == EAGAIN || errno == EWOULDBLOCK) {
-					continue;
+		for(int i = 0; i < count; i++) {
+			int fd = events[i].data.fd;
+			if(fd == b->socketWakeHandle) {
+				uint64_t wakes;
+				if(read(b->socketWakeHandle, &wakes, sizeof(wakes)) == -1 && errno != EAGAIN) {
+					logError("Could not read the wake up of the unix socket manager!");
 				}
-				else {
+				// Woken for room in a batch or for replies waiting to be written
+				std::vector<int> waiting;
+				for(std::pair<const int, SocketClient> & c : clients) {
+					waiting.push_back(c.first);
+				}
+				for(int w : waiting) {
+					flushClient(w);
+					serveClient(w);
+				}
+				for(std::vector<CommandBatch *>::iterator o = orphans.begin(); o != orphans.end();) {
+					if((*o)->isIdle()) {
+						logInfo("Finished command batch of a closed connection: " + (*o)->report());
+						delete *o;
+						o = orphans.erase(o);
+					}
+					else {
+						o++;
+					}
+				}
+			}
+			else if(fd == b->socketHandle) {
+				int client = accept4(b->socketHandle, nullptr, nullptr, SOCK_CLOEXEC);
+				if(client == -1) {
+					if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR || errno == ECONNABORTED) {
+						continue;
+					}
 					syslog(LOG_ERR, "Error while accepting connection to unix socket!");
 					logError("Error while accepting connection to unix socket!");
 					std::cout << "Error while accepting connection to unix socket!" << std::endl;
 					exit(1);
 				}
-			}
-		}
-		else {
-			continue;
-		}
-
-
-        logInfo("Accepted connection to unix socket...");
-        b->socketConnected.store(true);
-        int numBytesRead = 0;
-        bool doneReadingConnection = false;
-        bool gotLine = false;
-		memset(readBuffer, 0, SOCKET_BUFFER_SIZE);
-        while (!doneReadingConnection && !b->killed.load()) {
-
-			numBytesRead = recv(b->socket2Handle, readBuffer, SOCKET_BUFFER_SIZE-1, MSG_DONTWAIT); // Non blocking so that we can keep tabs on the status of buckey
-			if(numBytesRead < 0) {
-				if(errno == EWOULDBLOCK || errno == EAGAIN) {
-                    if(!b->isRunning()) { // Check to see if buckey ended yet, close sockets if it has
-						break;
-                    }
-                    continue;
+				if(clients.size() >= MAX_SOCKET_CLIENTS) {
+					logWarn("Refused connection to unix socket, " + std::to_string(clients.size()) + " clients are connected already");
+					const char refusal[] = "Too many clients are connected to Buckey\n";
+					send(client, refusal, sizeof(refusal) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+					close(client);
+					continue;
 				}
-				else {
-					doneReadingConnection = true;
-					gotLine = false;
-					//Probably not an error, probably a disconnect
-					break;
+				struct epoll_event e;
+				e.events = EPOLLIN;
+				e.data.fd = client;
+				if(epoll_ctl(epollHandle, EPOLL_CTL_ADD, client, &e) == -1) {
+					logError("Could not watch connection to unix socket!");
+					close(client);
+					continue;
 				}
+				clients[client] = SocketClient();
+				b->socketClientsLock.lock();
+				b->socketClients.push_back(client);
+				b->socketClientsLock.unlock();
+				logInfo("Accepted connection to unix socket, " + std::to_string(clients.size()) + " clients connected");
 			}
-			else if(numBytesRead == 0) {
-				doneReadingConnection = true;
-				gotLine = false;
-				break;
-			}
-			else {
-				for(unsigned short i = 0; i < numBytesRead; i++) {
-					s += readBuffer[i];
-					currentReadSize++;
-					if(currentReadSize > MAX_COMMAND_SIZE) {
-						b->reply("The command you are entering is too large!", ReplyType::ALERT);
-						break;
+			else if(clients.count(fd) > 0) {
+				SocketClient & c = clients[fd];
+				if(events[i].events & EPOLLOUT) {
+					flushClient(fd);
+				}
+				ssize_t numBytesRead = 0;
+				if((c.watching & EPOLLIN) && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+					numBytesRead = recv(fd, readBuffer, SOCKET_READ_SIZE, MSG_DONTWAIT);
+					if(numBytesRead == 0 || (numBytesRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) { // Disconnected, the lines it sent before are still handled
+						c.hungUp = true;
 					}
-
-					if(readBuffer[i] == '\n') {
-						gotLine = true;
-						if(s.size() > 0) {
-							if(s[0] == ':') {
-								s[0] = ' ';
-								b->passCommand(s);
-							}
-							else {
-								b->passInput(s);
-							}
-						}
-						s = "";
-						currentReadSize = 0;
+				}
+				for(ssize_t r = 0; r < numBytesRead; r++) {
+					if(c.skipping) {
+						c.skipping = readBuffer[r] != '\n';
+						continue;
+					}
+					c.partial += readBuffer[r];
+					if(readBuffer[r] == '\n') {
+						c.lines.push_back(c.partial);
+						c.partial.clear();
+					}
+					else if(c.partial.size() > MAX_COMMAND_SIZE) {
+						answer(fd, "The command you are entering is too large!\n");
+						c.partial.clear();
+						c.skipping = true;
 					}
 				}
-				memset(readBuffer, 0, SOCKET_BUFFER_SIZE);
+				serveClient(fd);
 			}
-        }
-
-        if(b->killed.load()) {
-			break;
-        }
-
-        if(!gotLine) {
-			b->socketConnected.store(false);
-        	close(b->socket2Handle);
 		}
 	}
 
-	close(b->socketHandle);
+	// Buckey is stopping, finish a stop requested by a signal so everyone waiting on input wakes up
+	b->requestStop();
+
+	// Let the batches finish while the pipeline still runs
+	std::vector<int> open;
+	for(std::pair<const int, SocketClient> & c : clients) {
+		open.push_back(c.first);
+	}
+	for(int fd : open) {
+		flushClient(fd); // Whatever fits in the connection still goes out
+		closeClient(fd);
+	}
+	for(CommandBatch * o : orphans) {
+		delete o;
+	}
+	close(epollHandle);
 }
 
 /**	\brief Attempts to pass input to the correct Mode
   *
-  * Buckey will attempt to match the supplied input to the correct Mode through the JSGF root grammar.
+  * The command is entered into the inputPipeline, which normalizes and filters it, matches it against the JSGF root grammar and passes it to the Mode it matches.
   * If no match is found, the command is not passed on, and the root grammar is outputted to the user.
+  * This returns as soon as the command is queued, it only waits if the pipeline is full.
   * \param [in] Command to pass to Buckey
+  * \param [in] Where the command came from, one of the INPUT_SOURCE_ names or the name of a Service. Repeats are only dropped if they come from the same source.
   *
   */
-void Buckey::passCommand(std::string command) {
-	MatchResult m = rootGrammar->match(command);
-	std::cout << command << std::endl;
-
-	if(m.matches) { //Process the user input if it matches a command
-		std::vector<std::string> tags = m.getMatchingTags(); //Get the tags that it matches
-		for(std::vector<std::string>::iterator i = tags.begin(); i != tags.end(); i++) { // Iterate until we find the tag that tells use which mode this input matches (MODE_TAG_PREFIX)
-			std::string s = *i;
-			if(StringHelper::stringStartsWith(s, MODE_TAG_PREFIX)) { // Found the tag telling us which mode it matches, extract the mode and pass the remaining tags and the input to the correct mode
-				std::string modeName = s.substr(strlen(MODE_TAG_PREFIX), s.length() - strlen(MODE_TAG_PREFIX));
-				std::cout << "Mode: " << modeName << std::endl;
-				tags.erase(i);
-				for(modeListEntry m : modes) {
-					if(m.second->getName() == modeName && m.second->getState() == ModeState::STARTED) {
-						m.second->input(command, tags);
-						return;
-					}
-				}
-			}
-		}
+void Buckey::passCommand(std::string command, const std::string & source) {
+	if(inputPipeline == nullptr || !inputPipeline->submit(command, source)) {
+		logWarn("Input pipeline is stopped, dropping command " + command);
 	}
-	else { // Output the root grammar for debugging purposes if the user input does not match
-		reply(rootGrammar->getText(), ReplyType::CONSOLE);
-		reply("Matches tags: " + StringHelper::concatenateStringVector(m.getMatchingTags(), ','), ReplyType::CONSOLE);
+}
+
+///Starts a CommandBatch that feeds commands into the inputPipeline, the caller deletes it. Returns nullptr if there is no inputPipeline.
+/// \param concurrency [in] most commands of the batch in the pipeline at once
+CommandBatch * Buckey::startCommandBatch(unsigned int concurrency) {
+	if(inputPipeline == nullptr) {
+		return nullptr;
 	}
+	return new CommandBatch(*inputPipeline, concurrency);
 }
 
+///Called in Buckey::init(), creates the inputPipeline and applies the input-pipeline settings of buckey.yaml
+void Buckey::setupInputPipeline() {
+	inputPipeline = new InputPipeline(std::bind(&Buckey::matchCommand, this, std::placeholders::_1), std::bind(&Buckey::dedupCommand, this, std::placeholders::_1), std::bind(&Buckey::dispatchCommand, this, std::placeholders::_1));
 
-/// \brief An internal loop that runs in the inputWatcher thread that checks the inputQue and passes input commands to Modes
-void Buckey::watchInputQue(Buckey * b) {
-	while(!b->killed.load()) {
-		b->inputQueMutex.lock();
-
-        if(!b->inputQue.empty()) {
-			if(!b->isInConversation()) {
-				std::string s = b->inputQue.front();
-				b->inputQue.pop();
-				b->inputQueMutex.unlock();
-				b->passCommand(s);
+	//Repeat windows, the ones of Modes are set in registerMode()
+	YAML::Node dedupConfig = coreConfigYAML["dedup"];
+	if(dedupConfig && dedupConfig["window"]) {
+		debouncer.setDefaultWindow(dedupConfig["window"].as<unsigned int>());
+	}
+	if(dedupConfig && dedupConfig["exempt-sources"]) {
+		for(YAML::const_iterator i = dedupConfig["exempt-sources"].begin(); i != dedupConfig["exempt-sources"].end(); i++) {
+			debouncer.exemptSource(i->as<std::string>());
+		}
+	}
+	else { // Batches repeat commands on purpose
+		debouncer.exemptSource(INPUT_SOURCE_BATCH);
+	}
+
+	YAML::Node pipelineConfig = coreConfigYAML["input-pipeline"];
+	if(!pipelineConfig) {
+		return;
+	}
+
+	for(int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+		PipelineStageType stage = (PipelineStageType) i;
+		YAML::Node stageConfig = pipelineConfig[InputPipeline::getStageName(stage)];
+		if(stageConfig) {
+			PipelineStageConfig c(DEFAULT_PIPELINE_WORKERS, DEFAULT_PIPELINE_QUEUE);
+			if(stageConfig["workers"]) {
+				c.workers = stageConfig["workers"].as<unsigned int>();
+			}
+			if(stageConfig["queue"]) {
+				c.queue = stageConfig["queue"].as<unsigned int>();
+			}
+			inputPipeline->setStageConfig(stage, c);
+		}
+	}
+
+	//Replacement dictionaries of PerWordSingleReplacementFilters, relative to the core config directory
+	if(pipelineConfig["filters"]) {
+		for(YAML::const_iterator i = pipelineConfig["filters"].begin(); i != pipelineConfig["filters"].end(); i++) {
+			cppfs::FileHandle dictionary = coreConfigDir.open(i->as<std::string>());
+			if(dictionary.exists()) {
+				inputPipeline->addFilter(new PerWordSingleReplacementFilter(dictionary.path()));
 			}
 			else {
-				b->inputQueMutex.unlock();
+				logWarn("Could not find input filter " + dictionary.path());
 			}
-        }
-        else {
-			b->inputQueMutex.unlock();
 		}
+	}
+}
+
+bool Buckey::matchCommand(PipelineCommand & command) {
+	std::shared_ptr<const RootGrammarSnapshot> root = getRootGrammarSnapshot();
+	GrammarMatch match;
+	if(!matchCache.lookup(command.text, root->generation, match)) {
+		match = root->match(command.text);
+		if(!match.matches) { // Output the root grammar for debugging purposes if the user input does not match
+			reply(root->text, ReplyType::CONSOLE);
+			if(!match.tags.empty()) {
+				reply("Matches tags: " + StringHelper::concatenateStringVector(match.tags, ','), ReplyType::CONSOLE);
+			}
+			return false;
+		}
+		if(match.handle == nullptr) { // Matched by the fallback grammar, which only has the name of the Mode
+			modeListEntry * entry = findMode(match.mode);
+			match.handle = entry == nullptr ? nullptr : entry->second;
+		}
+		matchCache.store(command.text, root->generation, match);
+	}
+
+	command.mode = match.mode;
+	command.target = match.handle;
+	command.tags = match.tags;
+	return true;
+}
+
+///Returns the current version of the root grammar, publishing a new one first if a grammar variable changed since it was made
+std::shared_ptr<const RootGrammarSnapshot> Buckey::getRootGrammarSnapshot() {
+	std::shared_ptr<const RootGrammarSnapshot> root = std::atomic_load(&rootSnapshot);
+	if(root->variableChanges == DynamicGrammar::getChangeCount()) {
+		return root;
+	}
+
+	rootGrammarLock.lock();
+	root = std::atomic_load(&rootSnapshot);
+	if(root->variableChanges != DynamicGrammar::getChangeCount()) { // Not republished by another worker while waiting for the lock
+		publishRootGrammar();
+		root = std::atomic_load(&rootSnapshot);
+	}
+	rootGrammarLock.unlock();
+	return root;
+}
+
+///Recompiles the Modes whose grammar variables changed and swaps in a new RootGrammarSnapshot, must be called with rootGrammarLock locked
+void Buckey::publishRootGrammar() {
+	unsigned long changes = DynamicGrammar::getChangeCount(); // Read first, so a change made while publishing is picked up by the next match
+	rootMatcher.refresh(*rootGrammar);
+	rootGrammarGeneration++;
+	std::shared_ptr<const RootGrammarSnapshot> root(new RootGrammarSnapshot(rootGrammarGeneration, changes, rootMatcher, rootGrammar->getText()));
+	std::atomic_store(&rootSnapshot, root);
+}
+
+///Returns the text of the current version of the root grammar, without the #JSGF header
+std::string Buckey::getRootGrammarText() {
+	return getRootGrammarSnapshot()->text;
+}
+
+bool Buckey::dedupCommand(PipelineCommand & command) {
+	if(!debouncer.accept(command.text, command.source, command.mode, command.submitted)) {
+		logInfo("Dropping repeated command " + command.text + (command.source.empty() ? "" : " from " + command.source));
+		return false;
+	}
+	return true;
+}
+
+bool Buckey::dispatchCommand(PipelineCommand & command) {
+	Mode * m = command.target;
+	if(m == nullptr) { // Matched by the whole root grammar, which only has the name of the Mode
+		modeListEntry * entry = findMode(command.mode);
+		if(entry == nullptr) {
+			return false;
+		}
+		m = entry->second;
+	}
+	if(m->getState() != ModeState::STARTED) {
+		return false;
+	}
 
+	std::cout << "Mode: " << command.mode << std::endl;
+	ModeExecutor * e = getModeExecutor(m);
+	if(e == nullptr || !e->submit(command.input, command.tags)) { // Modes get what the user typed or said, the rewritten text is only for matching
+		logWarn("Mode " + command.mode + " is too busy, dropping command " + command.text);
+		return false;
+	}
+	return true;
+}
+
+ModeExecutor * Buckey::getModeExecutor(const Mode * m) {
+	std::lock_guard<std::mutex> l(modeExecutorsLock);
+	std::unordered_map<const Mode *, ModeExecutor *>::iterator e = modeExecutors.find(m);
+	return e == modeExecutors.end() ? nullptr : e->second;
+}
+
+
+/// \brief An internal loop that runs in the inputWatcher thread that waits on the inputQue and passes input commands to Modes
+///
+/// Input that arrives during a conversation or prompt is left for them, endConversation() and the end of a prompt wake this thread to take whatever they did not.
+void Buckey::watchInputQue(Buckey * b) {
+	std::pair<std::string, std::string> s;
+	while(b->inputQue.pop(s, [b]() { return !b->isInConversation() && b->prompting.load() == 0; })) {
+		b->passCommand(s.first, s.second);
 	}
 }
 
@@ -550,15 +1013,28 @@ void Buckey::reply(std::string message, ReplyType t) {
 	std::cout << out << std::endl;
 	out = out + "\n";
 
-	if(socketConnected) {
-		char output[256];
-		strncpy(output, out.c_str(), 255);
-		send(socket2Handle, output, sizeof(output), MSG_DONTWAIT); // Don't block in case the client disconnects, this could lead to the suddenly disconnecting client eating up all available connections.
-	}
+	char line[256] = {0};
+	strncpy(line, out.c_str(), 255);
+	bool queued = false;
+	socketClientsLock.lock();
+	for(int c : socketClients) { // Written by manageUnixSocket(), so a client that stops reading holds up neither the other clients nor the caller
+		std::string & pending = socketOutput[c];
+		if(pending.size() + sizeof(line) <= SOCKET_OUTPUT_LIMIT) {
+			pending.append(line, sizeof(line));
+			queued = true;
+		}
+	}
+	socketClientsLock.unlock();
+	if(queued) {
+		wakeSocketManager();
+	}
 
 	Buckey::logInfo(out);
 
-	triggerEvents(ONOUTPUT, new OutputEventData(message, t));
+	OutputMessage output;
+	output.message = message;
+	output.type = t;
+	triggerEvents(OutputEvent, output);
 }
 
 /**
@@ -567,14 +1043,15 @@ void Buckey::reply(std::string message, ReplyType t) {
 void Buckey::startConversation() {
 	conversationMutex.lock();
 	inConversation.store(true);
-	triggerEvents(ONCONVERSATIONSTART, new EventData());
+	triggerEvents(ONCONVERSATIONSTART_ID, new EventData());
 }
 
 /// \brief Unlocks the conversationMutex. Call when finished with your conversation so that new conversations may start.
 void Buckey::endConversation() {
 	conversationMutex.unlock();
 	inConversation.store(false);
-	triggerEvents(ONCONVERSATIONEND, new EventData());
+	inputQue.wake();
+	triggerEvents(ONCONVERSATIONEND_ID, new EventData());
 }
 
 /// \brief Returns true if Buckey is in a conversation.
@@ -583,57 +1060,58 @@ bool Buckey::isInConversation() {
 }
 
 /// \brief Passes an input sting to the inputQue that will later be handled by the Mode in the Conversation or by the inputQueWatcher that will pass it to a command.
-void Buckey::passInput(std::string input) {
-	inputQueMutex.lock();
-	inputQue.push(input);
-	inputQueMutex.unlock();
+/// \param source [in] Where the input came from, passed on to passCommand()
+void Buckey::passInput(std::string input, const std::string & source) {
+	inputQue.push(std::make_pair(input, source));
 }
 
-/// \brief Prompts the user yes or no and will timeout after the specified amount of time if no input is received.
+/// \brief Prompts the user yes or no and waits until they answer or the timeout passes.
 /// \param const std::string prompt - The prompt that will be displayed to the user.
 /// \param int timeout - The timeout in second that the user had to reply by before the prompt times out.
+/// \return A PromptResult that has timed out, or holds a bool that is true if the answer matched {yes} in the confirm grammar
 PromptResult * Buckey::promptConfirmation(const std::string & prompt, int timeout) {
+	return promptConfirmationAsync(prompt, timeout).get();
+}
+
+/// \brief Prompts the user yes or no without waiting for the answer.
+///
+/// The answer is waited for on another thread that sleeps until input arrives or the timeout passes, get() the future for the same PromptResult promptConfirmation() returns.
+/// Input passed while the prompt is open goes to the prompt instead of being matched as a command. Destroying the future without calling get() waits for the prompt to finish.
+std::future<PromptResult *> Buckey::promptConfirmationAsync(const std::string & prompt, int timeout) {
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+	prompting++;
 	reply(prompt, ReplyType::PROMPT);
-	std::string result;
-	triggerEvents(ONENTERPROMPT, new PromptEventData("confirm"));
-	std::chrono::system_clock::time_point timeoutPassed = std::chrono::system_clock::now() + std::chrono::seconds(timeout);
-
-	bool timedOut = false;
-	bool found = false;
-    while(!killed.load() && !found) {
-    	if(std::chrono::system_clock::now() > timeoutPassed) {
-			timedOut = true;
-			break;
-    	}
-
-		inputQueMutex.lock();
-		if(!inputQue.empty()) {
-			found = true;
-			result = inputQue.front();
-			Buckey::reply("Got result: " + result, ReplyType::CONSOLE);
-			inputQue.pop();
-			inputQueMutex.unlock();
-			break;
-		}
-		inputQueMutex.unlock();
-    }
+	triggerEvents(ONENTERPROMPT_ID, new PromptEventData("confirm"));
+	return std::async(std::launch::async, &Buckey::waitForConfirmation, this, deadline);
+}
 
-    triggerEvents(ONEXITPROMPT, new EventData());
-    ///TODO: Have sphinx switch back to normal JSGF grammar
+/// \brief Body of promptConfirmationAsync(), waits on the inputQue for an answer and matches it against the confirm grammar
+PromptResult * Buckey::waitForConfirmation(std::chrono::steady_clock::time_point deadline) {
+	std::pair<std::string, std::string> answer;
+	bool timedOut = !inputQue.popUntil(answer, deadline);
+	std::string result = answer.first;
+	prompting--;
+	inputQue.wake(); // Let the inputWatcher go back to the input the prompt left behind
 
+	triggerEvents(ONEXITPROMPT_ID, new EventData());
 	if(timedOut) {
 		return new PromptResult();
 	}
+	Buckey::reply("Got result: " + result, ReplyType::CONSOLE);
+
+	// Anything that does not match {yes} counts as a no
+	bool * confirm = new bool(false);
+	promptLock.lock();
+	MatchResult m = confirmGrammar->match(result);
+	promptLock.unlock();
+	if(m.matches) {
+		std::vector<std::string> tags = m.getMatchingTags();
+		*confirm = std::find(tags.begin(), tags.end(), CONFIRM_YES_TAG) != tags.end();
+	}
 	else {
-		bool * confirm = new bool();
-		if(result == "confirm") { ///TODO: Process the input to match it against the confirm.gram to accept more than just "confirm"
-			*confirm = true;
-		}
-		else {
-			*confirm = false;
-		}
-		return new PromptResult(confirm);
+		logInfo("Answer \"" + result + "\" does not match the confirm grammar, taking it as no");
 	}
+	return new PromptResult(confirm);
 }
 
 void Buckey::addModeToRootGrammar(const Mode * m, DynamicGrammar * g) {
@@ -666,6 +1144,11 @@ void Buckey::addModeToRootGrammar(const Mode * m, DynamicGrammar * g) {
 			}
         }
     }
+    modeListEntry * entry = findMode(m->getName());
+    if(!rootMatcher.compileMode(m->getName(), *rootGrammar, g, entry == nullptr ? nullptr : entry->second)) {
+		logWarn("Could not compile the grammar of mode " + m->getName() + ", matching commands against the whole root grammar instead");
+    }
+    publishRootGrammar();
     rootGrammarLock.unlock();
 }
 
@@ -693,74 +1176,75 @@ void Buckey::removeModeFromRootGrammar(const Mode * m, DynamicGrammar * g) {
             break;
 		}
     }
+    rootMatcher.removeMode(m->getName());
+    publishRootGrammar();
     rootGrammarLock.unlock();
 }
 
-///TODO: Make registering Modes and Services error out when registering two services or modes with the same name
+serviceListEntry * Buckey::findService(const std::string & name) {
+	std::lock_guard<std::mutex> l(indexLock);
+	std::unordered_map<std::string, serviceListEntry *>::iterator s = serviceIndex.find(name);
+	return s == serviceIndex.end() ? nullptr : s->second;
+}
+
+modeListEntry * Buckey::findMode(const std::string & name) {
+	std::lock_guard<std::mutex> l(indexLock);
+	std::unordered_map<std::string, modeListEntry *>::iterator m = modeIndex.find(name);
+	return m == modeIndex.end() ? nullptr : m->second;
+}
+
 ///Starts and enables on startup the specified service if the service exists
 void Buckey::enableService(const std::string & serviceName) {
-	for(unsigned int i = 0; i < services.size(); i++) {
-		serviceListEntry s = services[i];
-		if(s.second->getName() == serviceName) {
-			logInfo("Enabling service " + serviceName);
-			services[i].first = true; // Enable the service on startup
-			s.second->start(); // Start the service
-			triggerEvents(ONSERVICEENABLE, new ServiceControlEventData(s.second));
-			return;
-		}
+	serviceListEntry * s = findService(serviceName);
+	if(s != nullptr) {
+		logInfo("Enabling service " + serviceName);
+		s->first = true; // Enable the service on startup
+		s->second->start(); // Start the service
+		triggerEvents(ONSERVICEENABLE_ID, new ServiceControlEventData(s->second));
 	}
 }
 
 ///Starts the specified service if the service exists
 void Buckey::startService(const std::string & serviceName) {
-	for(serviceListEntry s : services) {
-		if(s.second->getName() == serviceName) {
-			logInfo("Starting service " + serviceName);
-			s.second->start(); // Start the service
-			triggerEvents(ONSERVICESTART, new ServiceControlEventData(s.second));
-			return;
-		}
+	serviceListEntry * s = findService(serviceName);
+	if(s != nullptr) {
+		logInfo("Starting service " + serviceName);
+		s->second->start(); // Start the service
+		triggerEvents(ONSERVICESTART_ID, new ServiceControlEventData(s->second));
 	}
 }
 
 ///Reloads (stops and starts) the specified service if the service exists
 void Buckey::reloadService(const std::string & serviceName) {
-	for(serviceListEntry s  : services) {
-		if(s.second->getName() == serviceName) {
-			s.second->reload();
-			return;
-		}
+	serviceListEntry * s = findService(serviceName);
+	if(s != nullptr) {
+		s->second->reload();
 	}
 }
 
 ///Stops and disables from startup the specified service if the service exists
 void Buckey::disableService(const std::string & serviceName) {
-	for(unsigned int i = 0; i < services.size(); i++) {
-		serviceListEntry s = services[i];
-		if(s.second->getName() == serviceName) {
-			services[i].first = false; // Disable the service
-			s.second->stop(); // Stop the service
-			triggerEvents(ONSERVICEDISABLE, new ServiceControlEventData(s.second));
-			return;
-		}
+	serviceListEntry * s = findService(serviceName);
+	if(s != nullptr) {
+		s->first = false; // Disable the service
+		s->second->stop(); // Stop the service
+		triggerEvents(ONSERVICEDISABLE_ID, new ServiceControlEventData(s->second));
 	}
 }
 
 ///Stops the specified service if the service exists
 void Buckey::stopService(const std::string & serviceName) {
-	for(serviceListEntry s : services) {
-		if(s.second->getName() == serviceName) {
-			s.second->stop(); // Stop the service
-			triggerEvents(ONSERVICESTOP, new ServiceControlEventData(s.second));
-			return;
-		}
+	serviceListEntry * s = findService(serviceName);
+	if(s != nullptr) {
+		s->second->stop(); // Stop the service
+		triggerEvents(ONSERVICESTOP_ID, new ServiceControlEventData(s->second));
 	}
 }
 
 ///This method adds the service to Buckey's service list and changes the Service's state from SERVICE_NOT_REGISTED to DISABLED.
 void Buckey::registerService(Service * service) {
-	if(getServiceState(service->getName()) != ServiceState::SERVICE_NOT_REGISTERED) {
-		///TODO: Complain to an error log about registering a service with the same name as a service that already exists.
+	if(findService(service->getName()) != nullptr) {
+		logError("Can not register service " + service->getName() + ", a service with the same name is already registered!");
 		return;
 	}
 	service->registered(); // Change the state from NOT_REGISTERED to DISABLED
@@ -790,35 +1274,42 @@ void Buckey::registerService(Service * service) {
 
 	service->setConfigDir(serviceConfigDir);
 	service->setAssetsDir(serviceAssetsDir);
+	indexLock.lock();
 	services.push_back(serviceListEntry(false,service));
+	serviceIndex[service->getName()] = &services.back();
+	indexLock.unlock();
 
-	triggerEvents(ONSERVICEREGISTER, new ServiceControlEventData(service));
+	triggerEvents(ONSERVICEREGISTER_ID, new ServiceControlEventData(service));
 }
 
 ///Starts the specified mode.
 void Buckey::startMode(const std::string & name) {
-	for(modeListEntry m : modes) {
-		if(m.second->getName() == name) {
-			if(m.second->getState() == ModeState::STOPPED || m.second->getState() == ModeState::NOT_LOADED) {
-				logInfo("Starting mode " + name);
-				m.second->start();
-				triggerEvents(ONMODESTART, new ModeControlEventData(m.second));
-			}
-			return;
-		}
+	modeListEntry * m = findMode(name);
+	if(m != nullptr && (m->second->getState() == ModeState::STOPPED || m->second->getState() == ModeState::NOT_LOADED)) {
+		logInfo("Starting mode " + name);
+		m->second->start();
+		triggerEvents(ONMODESTART_ID, new ModeControlEventData(m->second));
 	}
 }
 
 ///Stops the specified mode.
 void Buckey::stopMode(const std::string & name) {
-	for(modeListEntry m : modes) {
-		if(m.second->getName() == name) {
-			if(m.second->getState() == ModeState::STARTED || m.second->getState() == ModeState::ERROR) {
-				logInfo("Stopping mode " + name);
-				m.second->stop();
-				triggerEvents(ONMODESTOP, new ModeControlEventData(m.second));
-			}
-			return;
+	modeListEntry * m = findMode(name);
+	if(m != nullptr && (m->second->getState() == ModeState::STARTED || m->second->getState() == ModeState::ERROR)) {
+		logInfo("Stopping mode " + name);
+		cancelMode(name);
+		m->second->stop();
+		triggerEvents(ONMODESTOP_ID, new ModeControlEventData(m->second));
+	}
+}
+
+///Cancels every command the specified mode is running or has queued, see ModeExecutor::isCancelled()
+void Buckey::cancelMode(const std::string & name) {
+	modeListEntry * m = findMode(name);
+	if(m != nullptr) {
+		ModeExecutor * e = getModeExecutor(m->second);
+		if(e != nullptr) {
+			e->cancel();
 		}
 	}
 }
@@ -826,68 +1317,95 @@ void Buckey::stopMode(const std::string & name) {
 ///Starts the specified mode and enables it on startup.
 /// \param name [in] name of the mode to be enabled.
 void Buckey::enableMode(const std::string & name) {
-	for(unsigned int i = 0; i < modes.size(); i++) {
-		modeListEntry m = modes[i];
-		if(m.second->getName() == name) {
-			modes[i].first = true; // Enable the mode on startup
-			if(m.second->getState() == ModeState::STOPPED || m.second->getState() == ModeState::NOT_LOADED) {
-				logInfo("Enabling mode " + name);
-				m.second->start();
-				triggerEvents(ONMODEENABLE, new ModeControlEventData(m.second));
-			}
-			return;
-		}
+	modeListEntry * m = findMode(name);
+	if(m == nullptr) {
+		return;
+	}
+	m->first = true; // Enable the mode on startup
+	if(m->second->getState() == ModeState::STOPPED || m->second->getState() == ModeState::NOT_LOADED) {
+		logInfo("Enabling mode " + name);
+		m->second->start();
+		triggerEvents(ONMODEENABLE_ID, new ModeControlEventData(m->second));
 	}
 }
 
 ///Stops the specified Mode and disables it from startup if it exists.
 /// \param name [in] name of the mode to be disabled.
 void Buckey::disableMode(const std::string & name) {
-	for(unsigned int i = 0; i < modes.size(); i++) {
-		modeListEntry m = modes[i];
-		if(m.second->getName() == name) {
-			modes[i].first = false; // Disable the mode.
-			if(m.second->getState() == ModeState::STARTED || m.second->getState() == ModeState::ERROR) {
-				logInfo("Disabling mode " + m.second->getName());
-				m.second->stop();
-				triggerEvents(ONMODEDISABLE, new ModeControlEventData(m.second));
-			}
-			return;
-		}
+	modeListEntry * m = findMode(name);
+	if(m == nullptr) {
+		return;
+	}
+	m->first = false; // Disable the mode.
+	if(m->second->getState() == ModeState::STARTED || m->second->getState() == ModeState::ERROR) {
+		logInfo("Disabling mode " + name);
+		cancelMode(name);
+		m->second->stop();
+		triggerEvents(ONMODEDISABLE_ID, new ModeControlEventData(m->second));
 	}
 }
 
 void Buckey::registerMode(Mode * m) {
-	if(getModeState(m->getName().c_str()) == ModeState::NOT_LOADED) {
-		cppfs::FileHandle modeAssetsDir = assetsDir.open("mode").open(m->getName());
-		if(!modeAssetsDir.isDirectory()) {
-			logWarn("Could not find assets directory for mode "+m->getName()+", setting one up...");
-			if(modeAssetsDir.createDirectory()) {
-				m->setupAssetsDir(modeAssetsDir);
-			}
-			else {
-				logError("Unable to create assets directory for mode "+m->getName()+"!");
-			}
+	if(findMode(m->getName()) != nullptr) {
+		logError("Can not register mode " + m->getName() + ", a mode with the same name is already registered!");
+		return;
+	}
+	cppfs::FileHandle modeAssetsDir = assetsDir.open("mode").open(m->getName());
+	if(!modeAssetsDir.isDirectory()) {
+		logWarn("Could not find assets directory for mode "+m->getName()+", setting one up...");
+		if(modeAssetsDir.createDirectory()) {
+			m->setupAssetsDir(modeAssetsDir);
 		}
+		else {
+			logError("Unable to create assets directory for mode "+m->getName()+"!");
+		}
+	}
 
-		cppfs::FileHandle modeConfigDir = configDir.open("mode").open(m->getName());
-		if(!modeConfigDir.isDirectory()) {
-			logWarn("Could not find config directory for mode "+m->getName()+", setting one up...");
-			if(modeConfigDir.createDirectory()) {
-				m->setupConfigDir(modeConfigDir);
-			}
-			else {
-				logError("Unable to create config directory for mode "+m->getName()+"!");
-			}
+	cppfs::FileHandle modeConfigDir = configDir.open("mode").open(m->getName());
+	if(!modeConfigDir.isDirectory()) {
+		logWarn("Could not find config directory for mode "+m->getName()+", setting one up...");
+		if(modeConfigDir.createDirectory()) {
+			m->setupConfigDir(modeConfigDir);
 		}
+		else {
+			logError("Unable to create config directory for mode "+m->getName()+"!");
+		}
+	}
 
-		m->setAssetsDir(modeAssetsDir);
-		m->setConfigDir(modeConfigDir);
+	m->setAssetsDir(modeAssetsDir);
+	m->setConfigDir(modeConfigDir);
 
-		modes.push_back(modeListEntry(false, m));
+	indexLock.lock();
+	modes.push_back(modeListEntry(false, m));
+	modeIndex[m->getName()] = &modes.back();
+	indexLock.unlock();
+
+	ModeExecutorConfig executorConfig;
+	YAML::Node executorYAML = coreConfigYAML["mode-executors"][m->getName()];
+	if(executorYAML) {
+		if(executorYAML["concurrency"]) {
+			executorConfig.concurrency = executorYAML["concurrency"].as<unsigned int>();
+		}
+		if(executorYAML["queue"]) {
+			executorConfig.queue = executorYAML["queue"].as<unsigned int>();
+		}
+		if(executorYAML["timeout"]) {
+			executorConfig.timeout = executorYAML["timeout"].as<unsigned int>();
+		}
+	}
+	modeExecutorsLock.lock();
+	modeExecutors[m] = new ModeExecutor(m, executorConfig);
+	modeExecutorsLock.unlock();
 
-		triggerEvents(ONMODEREGISTER, new ModeControlEventData(m));
+	YAML::Node windowYAML = coreConfigYAML["dedup"]["modes"][m->getName()];
+	if(windowYAML) {
+		debouncer.setModeWindow(m->getName(), windowYAML.as<unsigned int>());
+	}
+	else if(m->getRepeatWindow() > 0) {
+		debouncer.setModeWindow(m->getName(), m->getRepeatWindow());
 	}
+
+	triggerEvents(ONMODEREGISTER_ID, new ModeControlEventData(m));
 }
 
 ///Reloads the specified mode.
@@ -900,18 +1418,13 @@ void Buckey::reloadMode(const std::string & name) {
 ///Returns the ModeState that the specified Mode is in. If the Mode cannot be found, returns ModeState::NOT_LOADED
 /// \param name [in] name of the mode to be polled.
 const ModeState Buckey::getModeState(const std::string & name) {
-	for(modeListEntry m: modes) {
-		if(m.second->getName() == name) {
-			return m.second->getState();
-		}
-	}
-	return ModeState::NOT_LOADED;
+	modeListEntry * m = findMode(name);
+	return m == nullptr ? ModeState::NOT_LOADED : m->second->getState();
 }
 
 ///Pushes into output vector the names of the services that are enabled on startup.
 /// \param output [out] vector of strings of all the names of the services that are enabled on startup.
 const void Buckey::listEnabledServices(std::vector<std::string> & output) {
-	servicesList l = services;
 	for(serviceListEntry s : services) {
 		if(s.first == true) {
 			output.push_back(s.second->getName());
@@ -922,7 +1435,6 @@ const void Buckey::listEnabledServices(std::vector<std::string> & output) {
 ///Pushes into output vector the names of the services that are disabled on startup.
 /// \param output [out] vector of strings of all the names of the services that are disabled on startup.
 const void Buckey::listDisabledServices(std::vector<std::string> & output) {
-	servicesList l = services;
 	for(serviceListEntry s : services) {
 		if(s.first == false) {
 			output.push_back(s.second->getName());
@@ -1003,30 +1515,62 @@ cppfs::FileHandle Buckey::getTempFile(const std::string & extension) {
 /// \param name [in] name of the service
 /// \return ServiceState of the specified service. SERVICE_NOT_REGISTERED if it could not be found.
 const ServiceState Buckey::getServiceState(const std::string & serviceName) {
-	for(serviceListEntry s : services) {
-		if(s.second->getName() == serviceName) {
-			return s.second->getState();
-		}
-	}
-	return ServiceState::SERVICE_NOT_REGISTERED;
+	serviceListEntry * s = findService(serviceName);
+	return s == nullptr ? ServiceState::SERVICE_NOT_REGISTERED : s->second->getState();
 }
 
 ///Will return nullptr if the specified service name is not found!
 /// \param name [in] name of the service that is wanted
 /// \return Pointer to the requested service. nullptr if the service is not found.
 const Service * Buckey::getService(const std::string & serviceName) {
-	for(serviceListEntry s : services) {
-		if(s.second->getName() == serviceName) {
-			return s.second;
-		}
-	}
-	return nullptr;
+	serviceListEntry * s = findService(serviceName);
+	return s == nullptr ? nullptr : s->second;
 }
 
 const bool Buckey::isRunning() {
 	return running.load();
 }
 
+std::string Buckey::getEventStatistics() {
+	std::string report = EventStatistics::report();
+	std::string flow = describeFlowControl();
+	if(!flow.empty()) {
+		report += "Buckey event limits:\n" + flow;
+	}
+	if(EventJournal::isRecording()) {
+		EventJournal * journal = EventJournal::getInstance();
+		report += "Event journal: " + std::to_string(journal->getWritten()) + " written, " + std::to_string(journal->getDropped()) + " dropped\n";
+	}
+	if(inputPipeline != nullptr) {
+		report += "Input pipeline:\n" + inputPipeline->report();
+	}
+	report += "Match cache: " + matchCache.report() + "\n";
+	report += "Repeated commands: " + debouncer.report() + "\n";
+	modeExecutorsLock.lock();
+	if(!modeExecutors.empty()) {
+		report += "Mode executors:\n";
+		for(std::pair<const Mode * const, ModeExecutor *> & e : modeExecutors) {
+			report += "  " + e.first->getName() + ": " + e.second->report() + "\n";
+		}
+	}
+	modeExecutorsLock.unlock();
+	uint64_t published = EventBus::getInstance()->getPublished();
+	if(published > 0) {
+		report += "Event bus: " + std::to_string(published) + " published\n";
+	}
+	return report;
+}
+
+EventData * Buckey::decodeModeControl(PayloadReader & in) {
+	modeListEntry * m = instance->findMode(in.readString());
+	return m == nullptr ? nullptr : new ModeControlEventData(m->second);
+}
+
+EventData * Buckey::decodeServiceControl(PayloadReader & in) {
+	serviceListEntry * s = instance->findService(in.readString());
+	return s == nullptr ? nullptr : new ServiceControlEventData(s->second);
+}
+
 ///TODO: Make this const? Maybe not?
 DynamicGrammar * Buckey::getRootGrammar() {
 	return rootGrammar;
@@ -1035,6 +1579,17 @@ DynamicGrammar * Buckey::getRootGrammar() {
 ///Changes running to false and should trigger the shutdown of Buckey
 void Buckey::requestStop() {
 	killed.store(true);
+	inputQue.close();
+}
+
+///Async-signal-safe part of requestStop(), closing the input queue locks it so it is left to the unix socket manager or the main loop
+void Buckey::requestStopFromSignal() {
+	killed.store(true);
+	if(socketWakeHandle != -1) {
+		uint64_t wake = 1;
+		ssize_t written = write(socketWakeHandle, &wake, sizeof(wake)); // EAGAIN means it is already woken
+		(void) written;
+	}
 }
 
 ///Returns true if a call to requestStop has been made. Child threads should exit all loops and Services should begin joining their child threads.
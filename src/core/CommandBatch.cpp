@@ -0,0 +1,93 @@
+#include "CommandBatch.h"
+
+#include <sstream>
+
+CommandBatch::CommandBatch(InputPipeline & p, unsigned int c) : pipeline(p), concurrency(c == 0 ? 1 : c), inPipeline(0), submitted(0), dispatched(0), dropped(0)
+{
+	started = std::chrono::steady_clock::now();
+	finished = started;
+}
+
+CommandBatch::~CommandBatch()
+{
+	finish();
+}
+
+bool CommandBatch::submit(const std::string & command) {
+	std::unique_lock<std::mutex> l(batchLock);
+	while(inPipeline >= concurrency) {
+		left.wait(l);
+	}
+	inPipeline++;
+	submitted++;
+	l.unlock();
+
+	if(!pipeline.submit(command, INPUT_SOURCE_BATCH, std::bind(&CommandBatch::commandDone, this, std::placeholders::_1, std::placeholders::_2))) {
+		l.lock();
+		inPipeline--;
+		submitted--;
+		left.notify_all();
+		return false;
+	}
+	return true;
+}
+
+bool CommandBatch::isFull() {
+	std::lock_guard<std::mutex> l(batchLock);
+	return inPipeline >= concurrency;
+}
+
+bool CommandBatch::isIdle() {
+	std::lock_guard<std::mutex> l(batchLock);
+	return inPipeline == 0;
+}
+
+void CommandBatch::setRoomCallback(const std::function<void()> & callback) {
+	std::lock_guard<std::mutex> l(batchLock);
+	roomCallback = callback;
+}
+
+void CommandBatch::finish() {
+	std::unique_lock<std::mutex> l(batchLock);
+	while(inPipeline > 0) {
+		left.wait(l);
+	}
+}
+
+void CommandBatch::commandDone(const PipelineCommand & command, bool passed) {
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	std::unique_lock<std::mutex> l(batchLock);
+	latency.record(std::chrono::duration_cast<std::chrono::microseconds>(now - command.submitted).count());
+	if(passed) {
+		dispatched++;
+	}
+	else {
+		dropped++;
+	}
+	finished = now;
+	bool room = inPipeline >= concurrency || inPipeline == 1;
+	std::function<void()> callback = room ? roomCallback : nullptr; // The batch may be gone once the lock is released
+	inPipeline--;
+	left.notify_all();
+	l.unlock();
+
+	if(callback) {
+		callback();
+	}
+}
+
+std::string CommandBatch::report() {
+	std::lock_guard<std::mutex> l(batchLock);
+	double seconds = std::chrono::duration_cast<std::chrono::microseconds>(finished - started).count() / 1000000.0;
+	std::ostringstream out;
+	out << submitted << " commands in " << seconds << "s";
+	if(seconds > 0) {
+		out << " (" << (unsigned long long) (submitted / seconds) << " commands/sec)";
+	}
+	out << ", " << dispatched << " dispatched, " << dropped << " dropped, at most " << concurrency << " at once\n";
+	if(latency.count() > 0) {
+		out << "Latency: p50 " << LatencyHistogram::formatMicros(latency.percentile(50)) << ", p90 " << LatencyHistogram::formatMicros(latency.percentile(90))
+			<< ", p99 " << LatencyHistogram::formatMicros(latency.percentile(99)) << ", max " << LatencyHistogram::formatMicros(latency.max()) << "\n";
+	}
+	return out.str();
+}
@@ -0,0 +1,83 @@
+#include "CommandDebouncer.h"
+
+#include <algorithm>
+
+CommandDebouncer::CommandDebouncer() : defaultWindow(DEFAULT_DEDUP_WINDOW), longestWindow(DEFAULT_DEDUP_WINDOW), accepted(0), dropped(0)
+{
+
+}
+
+void CommandDebouncer::setDefaultWindow(unsigned int window) {
+	std::lock_guard<std::mutex> l(debounceLock);
+	defaultWindow = window;
+	longestWindow = std::max(longestWindow, window);
+}
+
+void CommandDebouncer::setModeWindow(const std::string & mode, unsigned int window) {
+	std::lock_guard<std::mutex> l(debounceLock);
+	modeWindows[mode] = window;
+	longestWindow = std::max(longestWindow, window);
+}
+
+unsigned int CommandDebouncer::getWindow(const std::string & mode) {
+	std::lock_guard<std::mutex> l(debounceLock);
+	std::unordered_map<std::string, unsigned int>::iterator w = modeWindows.find(mode);
+	return w == modeWindows.end() ? defaultWindow : w->second;
+}
+
+void CommandDebouncer::exemptSource(const std::string & source) {
+	std::lock_guard<std::mutex> l(debounceLock);
+	if(std::find(exemptSources.begin(), exemptSources.end(), source) == exemptSources.end()) {
+		exemptSources.push_back(source);
+	}
+}
+
+void CommandDebouncer::clearExemptSources() {
+	std::lock_guard<std::mutex> l(debounceLock);
+	exemptSources.clear();
+}
+
+bool CommandDebouncer::accept(const std::string & command, const std::string & source, const std::string & mode, std::chrono::steady_clock::time_point when) {
+	std::lock_guard<std::mutex> l(debounceLock);
+	std::unordered_map<std::string, unsigned int>::iterator w = modeWindows.find(mode);
+	unsigned int window = w == modeWindows.end() ? defaultWindow : w->second;
+	if(window == 0 || std::find(exemptSources.begin(), exemptSources.end(), source) != exemptSources.end()) {
+		accepted++;
+		return true;
+	}
+
+	std::string key = source + '\n' + command;
+	std::unordered_map<std::string, std::chrono::steady_clock::time_point>::iterator last = lastAccepted.find(key);
+	if(last != lastAccepted.end() && when - last->second < std::chrono::milliseconds(window)) {
+		dropped++;
+		return false;
+	}
+
+	if(last != lastAccepted.end()) {
+		last->second = when;
+	}
+	else {
+		if(lastAccepted.size() >= DEDUP_PRUNE_SIZE) {
+			prune(when);
+		}
+		lastAccepted[key] = when;
+	}
+	accepted++;
+	return true;
+}
+
+std::string CommandDebouncer::report() {
+	std::lock_guard<std::mutex> l(debounceLock);
+	return std::to_string(accepted) + " passed, " + std::to_string(dropped) + " repeats dropped, " + std::to_string(lastAccepted.size()) + " remembered";
+}
+
+void CommandDebouncer::prune(std::chrono::steady_clock::time_point now) {
+	for(std::unordered_map<std::string, std::chrono::steady_clock::time_point>::iterator i = lastAccepted.begin(); i != lastAccepted.end();) {
+		if(now - i->second >= std::chrono::milliseconds(longestWindow)) {
+			i = lastAccepted.erase(i);
+		}
+		else {
+			i++;
+		}
+	}
+}
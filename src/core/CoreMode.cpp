@@ -50,14 +50,15 @@ void CoreMode::start() {
 	delete i;
 
 	state = ModeState::STARTED;
-	finishHandler = Buckey::getInstance()->addListener(ONFINISHINIT, CoreMode::initFinished);
-	registerHandler = Buckey::getInstance()->addListener(ONMODEREGISTER, CoreMode::updateGrammar);
-	disableHandler = Buckey::getInstance()->addListener(ONMODEDISABLE, CoreMode::updateGrammar);
-	enableHandler = Buckey::getInstance()->addListener(ONMODEENABLE, CoreMode::updateGrammar);
-
-	serviceEnableHandler = Buckey::getInstance()->addListener(ONSERVICEENABLE, CoreMode::updateGrammar);
-	serviceDisableHandler = Buckey::getInstance()->addListener(ONSERVICEDISABLE, CoreMode::updateGrammar);
-	serviceRegisterHandler = Buckey::getInstance()->addListener(ONSERVICEREGISTER, CoreMode::updateGrammar);
+	finishHandler = Buckey::getInstance()->addListener(ONFINISHINIT_ID, CoreMode::initFinished);
+	// Registering, enabling and disabling at startup fires these back to back, so they are coalesced into one rebuild of the grammar
+	registerHandler = Buckey::getInstance()->addListener(ONMODEREGISTER_ID, CoreMode::updateGrammar, DispatchPolicy::DEFAULT, GRAMMAR_UPDATE_WINDOW);
+	disableHandler = Buckey::getInstance()->addListener(ONMODEDISABLE_ID, CoreMode::updateGrammar, DispatchPolicy::DEFAULT, GRAMMAR_UPDATE_WINDOW);
+	enableHandler = Buckey::getInstance()->addListener(ONMODEENABLE_ID, CoreMode::updateGrammar, DispatchPolicy::DEFAULT, GRAMMAR_UPDATE_WINDOW);
+
+	serviceEnableHandler = Buckey::getInstance()->addListener(ONSERVICEENABLE_ID, CoreMode::updateGrammar, DispatchPolicy::DEFAULT, GRAMMAR_UPDATE_WINDOW);
+	serviceDisableHandler = Buckey::getInstance()->addListener(ONSERVICEDISABLE_ID, CoreMode::updateGrammar, DispatchPolicy::DEFAULT, GRAMMAR_UPDATE_WINDOW);
+	serviceRegisterHandler = Buckey::getInstance()->addListener(ONSERVICEREGISTER_ID, CoreMode::updateGrammar, DispatchPolicy::DEFAULT, GRAMMAR_UPDATE_WINDOW);
 }
 
 
@@ -65,14 +66,14 @@ void CoreMode::stop() {
 	Buckey::getInstance()->removeModeFromRootGrammar(this, grammar);
 	delete grammar;
 	state = ModeState::STOPPED;
-	Buckey::getInstance()->unsetListener(ONFINISHINIT, finishHandler);
-	Buckey::getInstance()->unsetListener(ONMODEENABLE, enableHandler);
-	Buckey::getInstance()->unsetListener(ONMODEDISABLE, disableHandler);
-	Buckey::getInstance()->unsetListener(ONMODEREGISTER, registerHandler);
-
-	Buckey::getInstance()->unsetListener(ONSERVICEENABLE, serviceEnableHandler);
-	Buckey::getInstance()->unsetListener(ONSERVICEDISABLE, serviceDisableHandler);
-	Buckey::getInstance()->unsetListener(ONSERVICEREGISTER, serviceRegisterHandler);
+	Buckey::getInstance()->unsetListener(ONFINISHINIT_ID, finishHandler);
+	Buckey::getInstance()->unsetListener(ONMODEENABLE_ID, enableHandler);
+	Buckey::getInstance()->unsetListener(ONMODEDISABLE_ID, disableHandler);
+	Buckey::getInstance()->unsetListener(ONMODEREGISTER_ID, registerHandler);
+
+	Buckey::getInstance()->unsetListener(ONSERVICEENABLE_ID, serviceEnableHandler);
+	Buckey::getInstance()->unsetListener(ONSERVICEDISABLE_ID, serviceDisableHandler);
+	Buckey::getInstance()->unsetListener(ONSERVICEREGISTER_ID, serviceRegisterHandler);
 }
 
 void CoreMode::setupConfigDir(FileHandle cDir) {
@@ -85,7 +86,7 @@ void CoreMode::setupAssetsDir(FileHandle aDir) {
 
 	const char * content = "\
 grammar core;\n\
-public <command> = <quit> | <mode-command> | <service-command> | <list-command>;\n\
+public <command> = <quit> | <mode-command> | <service-command> | <list-command> | <statistics-command>;\n\
 <mode-command> = (<enable-mode> | <disable-mode> | <stop-mode> | <start-mode> | <reload>) mode {mode} <$modeList>;\n\
 <service-command> = (<enable-service> | <disable-service> | <stop-service> | <start-service> | <reload>) service {service} <$serviceList>;\n\
 <enable-service> = enable {enable};\n\
@@ -94,6 +95,7 @@ public <command> = <quit> | <mode-command> | <service-command> | <list-command>;
 <disable-service> = disable {disable};\n\
 <list-command> = <list> (enabled {enabled} | disabled {disabled} | (started | running) {started} | stopped {stopped} | [all | available ] {all}) (modes {modes} | services {services});\n\
 <list> = (list | show | tell me) {list};\n\
+<statistics-command> = (show | tell me) event (statistics | stats) {statistics};\n\
 <enable-mode> = (enable | enter | turn on | activate) {enable};\n\
 <disable-mode> = (disable | leave | turn off | deactivate | exit) {disable};\n\
 <stop-mode> = stop {stop};\n\
@@ -116,6 +118,11 @@ void CoreMode::input(std::string & command, std::vector<std::string> & tags) {
 		return;
 	}
 
+	if(action == "statistics") { // Far too long to be spoken, so it only goes to the console and the unix socket
+		b->reply(b->getEventStatistics(), ReplyType::CONSOLE);
+		return;
+	}
+
 	std::string & target = *(tags.begin()+2);
 	if(action == "start") {
 		if(*(tags.begin()+1) == "mode") {
@@ -362,7 +369,7 @@ void CoreMode::updateGrammar(EventData * data, std::atomic<bool> * done) {
 		b->addModeToRootGrammar(instance, grammar);
 		if(b->getServiceState("sphinx") == ServiceState::RUNNING) {
 			SphinxService * s = ((SphinxService *) b->getService("sphinx"));
-			s->setJSGF(b->getRootGrammar());
+			s->setJSGF(b->getRootGrammarText());
 			s->updateSearchMode(SphinxHelper::JSGF);
 			s->applyUpdates();
 		}
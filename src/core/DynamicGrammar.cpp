@@ -1,9 +1,10 @@
 #include "DynamicGrammar.h"
 
 unsigned long DynamicGrammar::nextID = 0;
+std::atomic<unsigned long> DynamicGrammar::changes(0);
 std::mutex DynamicGrammar::idLock;
 
-DynamicGrammar::DynamicGrammar() : Grammar() {
+DynamicGrammar::DynamicGrammar() : Grammar(), generation(0) {
 	idLock.lock();
 	id = nextID;
 	nextID++;
@@ -27,7 +28,7 @@ DynamicGrammar::DynamicGrammar() : Grammar() {
 	}
 }
 
-DynamicGrammar::DynamicGrammar(std::istream & inputStream) : Grammar(inputStream) {
+DynamicGrammar::DynamicGrammar(std::istream & inputStream) : Grammar(inputStream), generation(0) {
 	idLock.lock();
 	id = nextID;
 	nextID++;
@@ -51,7 +52,7 @@ DynamicGrammar::DynamicGrammar(std::istream & inputStream) : Grammar(inputStream
 	}
 }
 
-DynamicGrammar::DynamicGrammar(std::istream * inputStream) : Grammar(inputStream) {
+DynamicGrammar::DynamicGrammar(std::istream * inputStream) : Grammar(inputStream), generation(0) {
 	idLock.lock();
 	id = nextID;
 	nextID++;
@@ -121,6 +122,8 @@ void DynamicGrammar::setVariable(std::string name, std::string value) {
 		shared_ptr<Expansion> text(new Token(value));
 		shared_ptr<Expansion> container(new RequiredGrouping(text));
 		r->setRuleExpansion(container);
+		generation++;
+		changes++;
 	}
 }
 
@@ -129,9 +132,19 @@ void DynamicGrammar::setVariable(std::string name, std::shared_ptr<Expansion> va
 	if(r) {
 		shared_ptr<Expansion> container(new RequiredGrouping(value));
 		r->setRuleExpansion(container);
+		generation++;
+		changes++;
 	}
 }
 
+unsigned long DynamicGrammar::getGeneration() const {
+	return generation.load();
+}
+
+unsigned long DynamicGrammar::getChangeCount() {
+	return changes.load();
+}
+
 std::vector<std::string> DynamicGrammar::listVariables() {
 	return variables;
 }
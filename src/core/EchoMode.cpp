@@ -31,7 +31,7 @@ void EchoMode::stop() {
 	state = ModeState::STOPPED;
 }
 
-///TODO: Main thread is being hung up because passing input to a mode is synchronous and it waits for the mode to return, which it doesn't because it is waiting for input from the user, and the user cannot enter input because the CLI is hung waiting for it to return. Make everything go through inputQue and check inputQue in another thread separate from passInput().
+///Runs on the ModeExecutor of the echo mode, so waiting for the answer to the prompt only holds up this mode
 void EchoMode::input(std::string & command, std::vector<std::string> & tags) {
 	Buckey * buckey = Buckey::getInstance();
 	buckey->reply("pong", ReplyType::CONVERSATION);
@@ -1,19 +1,20 @@
 #include "EventData.h"
+#include "ObjectPool.h"
 
-EventData::EventData()
+EventData::EventData() : b(false), i(0)
 {
     //ctor
 }
 
-EventData::EventData(int j) {
+EventData::EventData(int j) : b(false) {
 	i = j;
 }
 
-EventData::EventData(bool k) {
+EventData::EventData(bool k) : i(0) {
 	b = k;
 }
 
-EventData::EventData(std::string t) {
+EventData::EventData(std::string t) : b(false), i(0) {
 	s = t;
 }
 
@@ -33,3 +34,25 @@ EventData::~EventData()
 {
     //dtor
 }
+
+void * EventData::operator new(std::size_t size) {
+	return ObjectPool<EventData>::allocate(size);
+}
+
+void EventData::operator delete(void * p, std::size_t size) {
+	ObjectPool<EventData>::release(p, size);
+}
+
+void EventData::serialize(PayloadWriter & out) const {
+	out.writeBool(b);
+	out.writeInt(i);
+	out.writeString(s);
+}
+
+EventData * EventData::deserialize(PayloadReader & in) {
+	EventData * d = new EventData();
+	d->b = in.readBool();
+	d->i = in.readInt();
+	d->s = in.readString();
+	return d;
+}
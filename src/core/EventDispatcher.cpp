@@ -0,0 +1,294 @@
+#include "EventDispatcher.h"
+
+#include <algorithm>
+
+thread_local int EventDispatcher::currentWorker = -1;
+std::atomic<unsigned int> EventDispatcher::configuredWorkers(std::max<unsigned int>(DEFAULT_EVENT_WORKERS, std::thread::hardware_concurrency()));
+std::atomic<unsigned int> EventDispatcher::deadlines[EVENT_PRIORITY_COUNT] = { {DEFAULT_REALTIME_DEADLINE}, {DEFAULT_INTERACTIVE_DEADLINE}, {DEFAULT_BACKGROUND_DEADLINE} };
+std::atomic<bool> EventDispatcher::instanceSet(false);
+EventDispatcher * EventDispatcher::instance = nullptr;
+std::mutex EventDispatcher::instanceLock;
+
+EventDispatcher * EventDispatcher::getInstance() {
+	if(!instanceSet.load()) {
+		instanceLock.lock();
+		if(!instanceSet.load()) {
+			instance = new EventDispatcher(configuredWorkers.load());
+			instanceSet.store(true);
+		}
+		instanceLock.unlock();
+	}
+	return instance;
+}
+
+bool EventDispatcher::setWorkerCount(unsigned int count) {
+	instanceLock.lock();
+	bool accepted = !instanceSet.load();
+	if(accepted) {
+		configuredWorkers.store(count);
+	}
+	instanceLock.unlock();
+	return accepted;
+}
+
+unsigned int EventDispatcher::getWorkerCount() {
+	return configuredWorkers.load();
+}
+
+bool EventDispatcher::isPooled() {
+	return configuredWorkers.load() > 0;
+}
+
+bool EventDispatcher::isWorkerThread() {
+	return currentWorker >= 0;
+}
+
+void EventDispatcher::setDeadline(EventPriority priority, unsigned int millis) {
+	deadlines[(int) priority].store(millis);
+}
+
+unsigned int EventDispatcher::getDeadline(EventPriority priority) {
+	return deadlines[(int) priority].load();
+}
+
+unsigned long EventDispatcher::getDeadlineMisses(EventPriority priority) const {
+	return deadlineMisses[(int) priority].load();
+}
+
+EventDispatcher::EventDispatcher(unsigned int workerCount) : queued(0), stopping(false), nextWorker(0), liveDedicated(0)
+{
+	for(unsigned int i = 0; i < EVENT_PRIORITY_COUNT; i++) {
+		deadlineMisses[i].store(0);
+	}
+
+	reaper = std::thread(runReaper, this);
+	timer = std::thread(runTimer, this);
+
+	for(unsigned int i = 0; i < workerCount; i++) {
+		workers.push_back(new Worker());
+	}
+
+	// Start the threads only once every deque exists, since workers steal from each other right away
+	for(unsigned int i = 0; i < workerCount; i++) {
+		workers[i]->thread = std::thread(runWorker, this, i);
+	}
+}
+
+EventDispatcher::~EventDispatcher()
+{
+	shutdown();
+	for(Worker * w : workers) {
+		delete w;
+	}
+	workers.clear();
+}
+
+void EventDispatcher::submit(Task task, EventPriority priority) {
+	if(workers.empty() || stopping.load()) { // No workers left to run it, so run it on the calling thread
+		task();
+		return;
+	}
+
+	unsigned int index;
+	if(currentWorker >= 0) { // Keep work triggered from a listener on the same worker, idle workers will steal it if needed
+		index = currentWorker;
+	}
+	else {
+		index = nextWorker.fetch_add(1) % workers.size();
+	}
+
+	QueuedTask q;
+	q.task = std::move(task);
+	q.queuedAt = std::chrono::steady_clock::now();
+
+	// Counted before it is published, a worker may steal and count it out as soon as it is in the deque
+	sleepLock.lock();
+	queued++;
+	sleepLock.unlock();
+
+	Worker * w = workers[index];
+	w->lock.lock();
+	w->tasks[(int) priority].push_back(std::move(q));
+	w->lock.unlock();
+	wakeup.notify_one();
+}
+
+void EventDispatcher::submitAfter(unsigned int millis, Task task) {
+	timerLock.lock();
+	if(stopping.load()) { // The timer thread is gone or about to be
+		timerLock.unlock();
+		task();
+		return;
+	}
+	timers.insert(std::make_pair(std::chrono::steady_clock::now() + std::chrono::milliseconds(millis), std::move(task)));
+	timerLock.unlock();
+	timerWakeup.notify_one();
+}
+
+void EventDispatcher::runTimer(EventDispatcher * d) {
+	std::unique_lock<std::mutex> l(d->timerLock);
+	while(true) {
+		if(d->timers.empty()) {
+			if(d->stopping.load()) {
+				break;
+			}
+			d->timerWakeup.wait(l);
+			continue;
+		}
+
+		std::multimap<std::chrono::steady_clock::time_point, Task>::iterator first = d->timers.begin();
+		if(!d->stopping.load() && first->first > std::chrono::steady_clock::now()) {
+			d->timerWakeup.wait_until(l, first->first);
+			continue; // Something earlier may have been added meanwhile
+		}
+
+		// Due, or stopping in which case nothing is left waiting
+		Task t = std::move(first->second);
+		d->timers.erase(first);
+		l.unlock();
+		t();
+		t = nullptr;
+		l.lock();
+	}
+}
+
+void EventDispatcher::startDedicated(Task task) {
+	DedicatedThread * t = new DedicatedThread();
+	liveDedicated++;
+	t->thread = std::thread(runDedicated, this, t, std::move(task));
+	releaseDedicated(t);
+}
+
+void EventDispatcher::runDedicated(EventDispatcher * d, DedicatedThread * t, Task task) {
+	task();
+	task = nullptr;
+	d->releaseDedicated(t);
+}
+
+void EventDispatcher::releaseDedicated(DedicatedThread * t) {
+	if(--(t->references) == 0) {
+		reaperLock.lock();
+		finishedThreads.push_back(t);
+		reaperLock.unlock();
+		reaperWakeup.notify_one();
+	}
+}
+
+void EventDispatcher::runReaper(EventDispatcher * d) {
+	std::vector<DedicatedThread *> toJoin;
+	std::unique_lock<std::mutex> l(d->reaperLock);
+	while(true) {
+		d->reaperWakeup.wait(l, [d]{ return !d->finishedThreads.empty() || (d->stopping.load() && d->liveDedicated.load() == 0); });
+		if(d->finishedThreads.empty()) {
+			break; // Stopping and every dedicated thread has been joined
+		}
+
+		toJoin.swap(d->finishedThreads);
+		l.unlock();
+		for(DedicatedThread * t : toJoin) {
+			t->thread.join();
+			delete t;
+			d->liveDedicated--;
+		}
+		toJoin.clear();
+		l.lock();
+	}
+}
+
+unsigned long EventDispatcher::dedicatedCount() const {
+	return liveDedicated.load();
+}
+
+unsigned long EventDispatcher::queuedCount() const {
+	return queued.load();
+}
+
+void EventDispatcher::checkDeadline(unsigned int lane, const QueuedTask & t) {
+	unsigned int deadline = deadlines[lane].load();
+	if(deadline > 0 && std::chrono::steady_clock::now() - t.queuedAt > std::chrono::milliseconds(deadline)) {
+		deadlineMisses[lane]++;
+	}
+}
+
+bool EventDispatcher::takeTask(unsigned int index, Task & out) {
+	for(unsigned int lane = 0; lane < EVENT_PRIORITY_COUNT; lane++) {
+		Worker * own = workers[index];
+		own->lock.lock();
+		if(!own->tasks[lane].empty()) {
+			QueuedTask t = std::move(own->tasks[lane].front());
+			own->tasks[lane].pop_front();
+			own->lock.unlock();
+			queued--;
+			checkDeadline(lane, t);
+			out = std::move(t.task);
+			return true;
+		}
+		own->lock.unlock();
+
+		// Own deque of this lane is empty, try to steal from the back of the others before looking at a lower lane
+		for(unsigned int i = 1; i < workers.size(); i++) {
+			Worker * victim = workers[(index + i) % workers.size()];
+			victim->lock.lock();
+			if(!victim->tasks[lane].empty()) {
+				QueuedTask t = std::move(victim->tasks[lane].back());
+				victim->tasks[lane].pop_back();
+				victim->lock.unlock();
+				queued--;
+				checkDeadline(lane, t);
+				out = std::move(t.task);
+				return true;
+			}
+			victim->lock.unlock();
+		}
+	}
+	return false;
+}
+
+void EventDispatcher::runWorker(EventDispatcher * d, unsigned int index) {
+	currentWorker = index;
+	Task t;
+	while(true) {
+		if(d->takeTask(index, t)) {
+			t();
+			t = nullptr; // Release anything the task captured before going idle
+			continue;
+		}
+
+		std::unique_lock<std::mutex> l(d->sleepLock);
+		if(d->queued.load() == 0) {
+			if(d->stopping.load()) {
+				break;
+			}
+			d->wakeup.wait(l, [d]{ return d->queued.load() > 0 || d->stopping.load(); });
+		}
+	}
+	currentWorker = -1;
+}
+
+void EventDispatcher::shutdown() {
+	timerLock.lock();
+	sleepLock.lock();
+	stopping.store(true);
+	sleepLock.unlock();
+	timerLock.unlock();
+	timerWakeup.notify_all();
+	wakeup.notify_all();
+
+	// Timers may still submit work, so they are flushed before the workers are joined
+	if(timer.joinable() && timer.get_id() != std::this_thread::get_id()) {
+		timer.join();
+	}
+
+	for(Worker * w : workers) {
+		if(w->thread.joinable() && w->thread.get_id() != std::this_thread::get_id()) {
+			w->thread.join();
+		}
+	}
+
+	reaperLock.lock();
+	reaperLock.unlock();
+	reaperWakeup.notify_all();
+	if(reaper.joinable() && reaper.get_id() != std::this_thread::get_id()) {
+		reaper.join();
+	}
+}
@@ -0,0 +1,302 @@
+#include "EventJournal.h"
+#include "EventSource.h"
+
+std::atomic<bool> EventJournal::recording(false);
+EventJournal * EventJournal::instance;
+std::atomic<bool> EventJournal::instanceSet(false);
+std::mutex EventJournal::instanceLock;
+
+EventJournal * EventJournal::getInstance() {
+	if(!instanceSet.load()) {
+		instanceLock.lock();
+		if(!instanceSet.load()) {
+			instance = new EventJournal();
+			instanceSet.store(true);
+		}
+		instanceLock.unlock();
+	}
+	return instance;
+}
+
+EventJournal::EventJournal() : replaying(false), file(nullptr), stopping(false), recorders(0), ring(nullptr), head(0), tail(0), written(0), dropped(0)
+{
+	sourceNames.push_back("");
+}
+
+bool EventJournal::open(const std::string & path) {
+	std::lock_guard<std::mutex> l(fileLock);
+	if(file != nullptr || replaying.load()) {
+		return false;
+	}
+
+	file = fopen(path.c_str(), "wb");
+	if(file == nullptr) {
+		return false;
+	}
+	fwrite(JOURNAL_MAGIC, 1, sizeof(JOURNAL_MAGIC) - 1, file);
+
+	if(ring == nullptr) { // Never freed, a trigger may still be writing to it after close()
+		ring = new Slot[JOURNAL_RING_SIZE];
+		for(uint64_t i = 0; i < JOURNAL_RING_SIZE; i++) {
+			ring[i].sequence.store(i);
+		}
+	}
+	typesWritten.clear();
+	sourcesWritten.clear();
+	written.store(0);
+	dropped.store(0);
+	openedAt = std::chrono::steady_clock::now();
+	stopping.store(false);
+	writer = std::thread(runWriter, this);
+	recording.store(true, std::memory_order_release);
+	return true;
+}
+
+void EventJournal::close() {
+	std::lock_guard<std::mutex> l(fileLock);
+	if(file == nullptr) {
+		return;
+	}
+
+	// record() counts itself in before it checks recording, so once recorders is 0 no trigger can reach the ring any more
+	recording.store(false);
+	while(recorders.load() > 0) {
+		std::this_thread::yield();
+	}
+	sleepLock.lock();
+	stopping.store(true);
+	sleepLock.unlock();
+	wakeup.notify_all();
+	writer.join();
+
+	fclose(file);
+	file = nullptr;
+}
+
+void EventJournal::setReplayMode(bool replay) {
+	replaying.store(replay);
+}
+
+bool EventJournal::isReplayMode() const {
+	return replaying.load();
+}
+
+void EventJournal::record(uint32_t source, EventTypeID type, const EventData * data) {
+	recorders++;
+	if(!recording.load()) { // close() has started, the writer may already be gone
+		recorders--;
+		return;
+	}
+
+	uint64_t position = head.load(std::memory_order_relaxed);
+	Slot * slot;
+	while(true) {
+		slot = &ring[position & (JOURNAL_RING_SIZE - 1)];
+		uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+		if(sequence == position) {
+			if(head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if(sequence < position) { // The writer has not emptied this slot since the last lap, the ring is full
+			dropped++;
+			recorders--;
+			return;
+		}
+		else { // Another trigger claimed it first
+			position = head.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - openedAt).count();
+	slot->source = source;
+	slot->type = type;
+	slot->payload.clear();
+	if(data != nullptr) {
+		PayloadWriter out(slot->payload);
+		data->serialize(out);
+	}
+	slot->sequence.store(position + 1, std::memory_order_release);
+	recorders--;
+}
+
+bool EventJournal::drain(std::string & buffer) {
+	PayloadWriter out(buffer);
+	bool drained = false;
+	while(true) {
+		Slot & slot = ring[tail & (JOURNAL_RING_SIZE - 1)];
+		if(slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+			break;
+		}
+
+		if(slot.type >= typesWritten.size()) {
+			typesWritten.resize(slot.type + 1, false);
+		}
+		if(!typesWritten[slot.type]) {
+			out.writeByte('T');
+			out.writeUInt32(slot.type);
+			out.writeString(EventTypes::getName(slot.type));
+			typesWritten[slot.type] = true;
+		}
+		if(slot.source >= sourcesWritten.size()) {
+			sourcesWritten.resize(slot.source + 1, false);
+		}
+		if(!sourcesWritten[slot.source]) {
+			tableLock.lock();
+			std::string name = slot.source < sourceNames.size() ? sourceNames[slot.source] : "";
+			tableLock.unlock();
+			out.writeByte('S');
+			out.writeUInt32(slot.source);
+			out.writeString(name);
+			sourcesWritten[slot.source] = true;
+		}
+
+		out.writeByte('E');
+		out.writeUInt64(slot.micros);
+		out.writeUInt32(slot.source);
+		out.writeUInt32(slot.type);
+		out.writeString(slot.payload);
+
+		slot.sequence.store(tail + JOURNAL_RING_SIZE, std::memory_order_release);
+		tail++;
+		written++;
+		drained = true;
+	}
+	return drained;
+}
+
+void EventJournal::runWriter(EventJournal * j) {
+	std::string buffer;
+	while(true) {
+		bool stop = j->stopping.load(); // Read before draining, so the last drain sees everything recorded before close()
+		buffer.clear();
+		if(j->drain(buffer)) {
+			fwrite(buffer.data(), 1, buffer.size(), j->file);
+			continue;
+		}
+		if(stop) {
+			break;
+		}
+
+		fflush(j->file);
+		std::unique_lock<std::mutex> l(j->sleepLock);
+		if(!j->stopping.load()) {
+			j->wakeup.wait_for(l, std::chrono::milliseconds(JOURNAL_WRITER_INTERVAL));
+		}
+	}
+	fflush(j->file);
+}
+
+bool EventJournal::replay(const std::string & path, bool realtime, unsigned long & replayed, unsigned long & skipped) {
+	replayed = 0;
+	skipped = 0;
+
+	FILE * in = fopen(path.c_str(), "rb");
+	if(in == nullptr) {
+		return false;
+	}
+	std::string contents;
+	char chunk[4096];
+	std::size_t read;
+	while((read = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+		contents.append(chunk, read);
+	}
+	fclose(in);
+
+	std::size_t magicLength = sizeof(JOURNAL_MAGIC) - 1;
+	if(contents.compare(0, magicLength, JOURNAL_MAGIC) != 0) {
+		return false;
+	}
+
+	// IDs in the file are those of the recording process, map them to this one
+	std::unordered_map<uint32_t, EventTypeID> types;
+	std::unordered_map<uint32_t, std::string> names;
+	PayloadReader journal(contents.data() + magicLength, contents.size() - magicLength);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while(!journal.atEnd()) {
+		uint8_t kind = journal.readByte();
+		if(kind == 'T') {
+			uint32_t id = journal.readUInt32();
+			types[id] = EventTypes::intern(journal.readString());
+		}
+		else if(kind == 'S') {
+			uint32_t id = journal.readUInt32();
+			names[id] = journal.readString();
+		}
+		else if(kind == 'E') {
+			uint64_t micros = journal.readUInt64();
+			uint32_t source = journal.readUInt32();
+			uint32_t type = journal.readUInt32();
+			std::string payload = journal.readString();
+			if(!journal.good()) { // Cut off mid record, the recording process probably died
+				break;
+			}
+
+			if(realtime) {
+				std::this_thread::sleep_until(start + std::chrono::microseconds(micros));
+			}
+
+			EventTypeID eventType = types[type];
+			EventSource * es = nullptr;
+			EventDecoder decoder = EventData::deserialize;
+			tableLock.lock();
+			std::unordered_map<std::string, EventSource *>::iterator s = sources.find(names[source]);
+			if(s != sources.end()) {
+				es = s->second;
+			}
+			std::unordered_map<EventTypeID, EventDecoder>::iterator d = decoders.find(eventType);
+			if(d != decoders.end()) {
+				decoder = d->second;
+			}
+			tableLock.unlock();
+
+			PayloadReader p(payload.data(), payload.size());
+			EventData * data = es == nullptr ? nullptr : decoder(p);
+			if(data == nullptr) {
+				skipped++;
+				continue;
+			}
+			es->replayEvent(eventType, data);
+			replayed++;
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+void EventJournal::setDecoder(EventTypeID type, EventDecoder decoder) {
+	std::lock_guard<std::mutex> l(tableLock);
+	decoders[type] = decoder;
+}
+
+uint32_t EventJournal::registerSource(const std::string & name, EventSource * source) {
+	std::lock_guard<std::mutex> l(tableLock);
+	sources[name] = source;
+	for(uint32_t i = 1; i < sourceNames.size(); i++) {
+		if(sourceNames[i] == name) {
+			return i;
+		}
+	}
+	sourceNames.push_back(name);
+	return sourceNames.size() - 1;
+}
+
+void EventJournal::unregisterSource(EventSource * source) {
+	std::lock_guard<std::mutex> l(tableLock);
+	for(std::unordered_map<std::string, EventSource *>::iterator i = sources.begin(); i != sources.end(); i++) {
+		if(i->second == source) {
+			sources.erase(i);
+			return;
+		}
+	}
+}
+
+unsigned long long EventJournal::getWritten() const {
+	return written.load();
+}
+
+unsigned long long EventJournal::getDropped() const {
+	return dropped.load();
+}
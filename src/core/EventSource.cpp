@@ -1,124 +1,491 @@
 #include "EventSource.h"
+#include "ObjectPool.h"
 
-EventSource::EventSource() : requestJoin(false)
+#include <sstream>
+
+unsigned long EventSource::nextID = 0;
+std::mutex EventSource::idLock;
+thread_local unsigned int EventSource::listenerDepth = 0;
+
+EventSource::EventSource() : requestJoin(false), inFlight(0), journalSource(0), handlers(new ListenerTable())
 {
-    threadManipulationLock.lock();
-    managerThread = std::thread(EventSource::manageThreads, this);
-    threadManipulationLock.unlock();
+
 }
 
 EventSource::~EventSource()
 {
+    if(journalSource != 0) {
+    	EventJournal::getInstance()->unregisterSource(this);
+    }
     killThreads();
 }
 
+void EventSource::setJournalName(const std::string & name) {
+	journalSource = EventJournal::getInstance()->registerSource(name, this);
+}
+
 unsigned long EventSource::handlerCount() {
-	return threads.size();
+	return inFlight.load();
 }
 
 void EventSource::killThreads() {
     requestJoin.store(true);
-    threadManipulationLock.lock();
-    managerThread.join();
-    for(std::pair<std::thread *, std::atomic<bool> *> * p : threads) {
-        p->first->join();
-        delete p->first;
-        delete p->second;
-        delete p;
-    }
-    threads.clear();
-    threadManipulationLock.unlock();
-}
-
-void EventSource::manageThreads(EventSource * es) {
-    while(!es->requestJoin) {
-        es->threadManipulationLock.lock();
-        bool done = false;
-        while(!done) {
-			done = true;
-			for(std::vector<std::pair<std::thread *, std::atomic<bool> *> *>::iterator i = es->threads.begin(); i != es->threads.end(); i++) {
-				std::pair<std::thread *,std::atomic<bool> *> * p = *i;
-				if(p->second->load()) {
-					p->first->join();
-					delete p->first;
-					delete p->second;
-					delete p;
-					es->threads.erase(i);
-					done = false;
-					break;
+    std::unique_lock<std::mutex> l(drainLock);
+    drained.wait(l, [this]{ return inFlight.load() == 0; });
+}
+
+void EventSource::handlerFinished() {
+	// Hold drainLock while counting out so killThreads() cannot miss the notification (or destroy us mid-notify)
+	std::lock_guard<std::mutex> l(drainLock);
+	if(--inFlight == 0) {
+		drained.notify_all();
+	}
+}
+
+void * EventSource::DispatchRecord::operator new(std::size_t size) {
+	return ObjectPool<DispatchRecord>::allocate(size);
+}
+
+void EventSource::DispatchRecord::operator delete(void * p, std::size_t size) {
+	ObjectPool<DispatchRecord>::release(p, size);
+}
+
+void EventSource::DispatchRecord::call() {
+	std::atomic<bool> done(false);
+	ListenerScope scope;
+	handler(data.get(), &done);
+}
+
+bool EventSource::DispatchRecord::merge(QueuedListener * newer) {
+	DispatchRecord * n = static_cast<DispatchRecord *>(newer);
+	if(!batchAware || !n->batchAware || n->handler != handler) {
+		return false;
+	}
+	// Both batches were made by flushBatch() for this record alone, nobody else reads them
+	static_cast<BatchEventData *>(data.get())->append(*static_cast<BatchEventData *>(n->data.get()));
+	return true;
+}
+
+void EventSource::runRecord(QueuedListener * record) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	record->call();
+	std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+	EventStatistics::recordRun(record->type, record->listener,
+		std::chrono::duration_cast<std::chrono::microseconds>(start - record->triggeredAt).count(),
+		std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count());
+
+	EventSource * es = record->source;
+	// Keep the gate alive past the record, setFlowControl() may have replaced it in the table meanwhile
+	std::shared_ptr<FlowGate> gate = record->gate;
+	std::shared_ptr<Strand> strand = record->strand;
+	delete record; // Drops this listener's share of the EventData
+	if(strand) {
+		releaseStrand(strand.get());
+	}
+	if(gate) {
+		es->releaseGate(gate.get());
+	}
+	es->handlerFinished();
+}
+
+void EventSource::dispatch(const Listener & l, EventTypeID eventType, const std::shared_ptr<EventData> & data, EventPriority priority, const std::shared_ptr<FlowGate> & gate) {
+	EventStatistics::recordTrigger(eventType, l.id);
+	if(l.policy == DispatchPolicy::INLINE) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::atomic<bool> done(false);
+		{
+			ListenerScope scope;
+			l.handler(data.get(), &done);
+		}
+		EventStatistics::recordRun(eventType, l.id, 0, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+		handlerFinished();
+		return;
+	}
+
+	DispatchRecord * record = new DispatchRecord();
+	record->source = this;
+	record->handler = l.handler;
+	record->type = eventType;
+	record->listener = l.id;
+	record->policy = l.policy;
+	record->priority = priority;
+	record->triggeredAt = std::chrono::steady_clock::now();
+	record->data = data;
+	record->batchAware = l.coalesceWindow > 0;
+	record->gate = gate;
+	record->strand = l.strand;
+	admit(record);
+}
+
+void EventSource::admit(QueuedListener * record) {
+	FlowGate * gate = record->gate.get();
+	if(gate == nullptr) {
+		schedule(record);
+		return;
+	}
+
+	std::unique_lock<std::mutex> l(gate->lock);
+	bool counted = false;
+	while(true) {
+		if(gate->counters.running < gate->limits.maxInFlight) {
+			gate->counters.running++;
+			l.unlock();
+			schedule(record);
+			return;
+		}
+		if(gate->waiting.size() < gate->limits.maxQueued) {
+			gate->waiting.push_back(record);
+			return;
+		}
+
+		QueuedListener * victim = nullptr;
+		switch(gate->limits.overflow) {
+			case OverflowPolicy::BLOCK:
+				if(!counted) {
+					gate->counters.blocked++;
+					counted = true;
 				}
-			}
-        }
-        es->threadManipulationLock.unlock();
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
+				if(EventDispatcher::isWorkerThread()) { // Waiting would hold a worker the queued listeners need to start
+					gate->waiting.push_back(record);
+					return;
+				}
+				gate->space.wait(l);
+				continue;
+			case OverflowPolicy::DROP_NEWEST:
+				gate->counters.droppedNewest++;
+				l.unlock();
+				discard(record);
+				return;
+			case OverflowPolicy::MERGE:
+				for(std::deque<QueuedListener *>::reverse_iterator i = gate->waiting.rbegin(); i != gate->waiting.rend(); i++) {
+					if((*i)->listener == record->listener && (*i)->merge(record)) {
+						gate->counters.merged++;
+						l.unlock();
+						discard(record);
+						return;
+					}
+				}
+				// Nothing of this listener to merge with, make room like DROP_OLDEST
+				// fallthrough
+			case OverflowPolicy::DROP_OLDEST:
+				if(gate->waiting.empty()) { // maxQueued is 0, so the newest is also the oldest
+					gate->counters.droppedNewest++;
+					l.unlock();
+					discard(record);
+					return;
+				}
+				victim = gate->waiting.front();
+				gate->waiting.pop_front();
+				gate->waiting.push_back(record);
+				gate->counters.droppedOldest++;
+				l.unlock();
+				discard(victim);
+				return;
+		}
+	}
+}
+
+void EventSource::releaseGate(FlowGate * gate) {
+	QueuedListener * next = nullptr;
+	gate->lock.lock();
+	if(gate->waiting.empty()) {
+		gate->counters.running--;
+	}
+	else { // The next listener takes over our slot
+		next = gate->waiting.front();
+		gate->waiting.pop_front();
+	}
+	gate->lock.unlock();
+	gate->space.notify_all();
+
+	if(next != nullptr) {
+		schedule(next);
+	}
 }
 
-void EventSource::triggerEvents(std::string eventType, EventData * arg) {
+void EventSource::discard(QueuedListener * record) {
+	EventSource * es = record->source;
+	EventStatistics::recordDrop(record->type, record->listener);
+	delete record;
+	es->handlerFinished();
+}
+
+void EventSource::schedule(QueuedListener * record) {
+	Strand * strand = record->strand.get();
+	if(strand != nullptr) {
+		strand->lock.lock();
+		if(strand->busy) { // Started by releaseStrand() once the calls before it have returned
+			strand->waiting.push_back(record);
+			strand->lock.unlock();
+			return;
+		}
+		strand->busy = true;
+		strand->lock.unlock();
+	}
+	start(record);
+}
+
+void EventSource::releaseStrand(Strand * strand) {
+	QueuedListener * next = nullptr;
+	strand->lock.lock();
+	if(strand->waiting.empty()) {
+		strand->busy = false;
+	}
+	else {
+		next = strand->waiting.front();
+		strand->waiting.pop_front();
+	}
+	strand->lock.unlock();
+
+	if(next != nullptr) {
+		start(next);
+	}
+}
+
+void EventSource::start(QueuedListener * record) {
+	EventDispatcher * dispatcher = EventDispatcher::getInstance();
+	EventDispatcher::Task task = [record]() {
+		EventSource::runRecord(record);
+	};
+	bool pooled = EventDispatcher::isPooled();
+	if(record->policy == DispatchPolicy::DEDICATED || (record->policy != DispatchPolicy::POOLED && !pooled)) {
+		dispatcher->startDedicated(std::move(task));
+	}
+	else {
+		dispatcher->submit(std::move(task), record->priority);
+	}
+}
+
+void EventSource::coalesce(const Listener & l, EventTypeID eventType, const std::shared_ptr<EventData> & data) {
+	coalesceLock.lock();
+	std::unordered_map<void(*)(EventData *, std::atomic<bool> *), BatchEventData *>::iterator i = pendingBatches.find(l.handler);
+	if(i != pendingBatches.end()) {
+		i->second->add(eventType, data);
+		coalesceLock.unlock();
+		return;
+	}
+
+	BatchEventData * batch = new BatchEventData();
+	batch->add(eventType, data);
+	pendingBatches[l.handler] = batch;
+	coalesceLock.unlock();
+
+	// The whole batch counts as one in flight listener from now until its handler returns
+	inFlight++;
+	Listener listener = l;
+	EventPriority priority = EventTypes::getPriority(eventType);
+	EventSource * es = this;
+	EventDispatcher::getInstance()->submitAfter(l.coalesceWindow, [es, listener, eventType, priority]() {
+		es->flushBatch(listener, eventType, priority);
+	});
+}
+
+void EventSource::flushBatch(const Listener & l, EventTypeID eventType, EventPriority priority) {
+	coalesceLock.lock();
+	BatchEventData * batch = pendingBatches[l.handler];
+	pendingBatches.erase(l.handler);
+	coalesceLock.unlock();
+
+	std::shared_ptr<const ListenerTable> table = std::atomic_load(&handlers);
+	std::shared_ptr<FlowGate> gate;
+	if(eventType < table->size()) {
+		gate = (*table)[eventType].gate;
+	}
+
+	// Inline coalescing listeners run on the timer thread, since the triggering threads are long gone
+	dispatch(l, eventType, std::shared_ptr<EventData>(batch, std::default_delete<EventData>(), ObjectPoolAllocator<EventData>()), priority, gate);
+}
+
+void EventSource::triggerEvents(EventTypeID eventType, EventData * arg) {
+	trigger(eventType, arg, false);
+}
+
+void EventSource::replayEvent(EventTypeID eventType, EventData * arg) {
+	trigger(eventType, arg, true);
+}
+
+void EventSource::trigger(EventTypeID eventType, EventData * arg, bool replay) {
+	// Every listener of this trigger shares ownership of arg, it is deleted here if nobody is listening
+	std::shared_ptr<EventData> data(arg, std::default_delete<EventData>(), ObjectPoolAllocator<EventData>());
 	if(!requestJoin) { // Only trigger if we are still running.
-		threadManipulationLock.lock();
-		/*for(std::pair<std::string,std::vector<void(*)(EventData *, std::atomic<bool> *)>> p : handlers) {
-			if(p.first == eventType) {
-				for(void (*h)(EventData *, std::atomic<bool> *) : p.second) {
-					std::atomic<bool> * doneAtomic = new std::atomic<bool>(false);
-					std::thread * eventThread = new std::thread(h, arg, doneAtomic);
-					std::pair<std::thread *,std::atomic<bool> *> * newPair = new std::pair<std::thread *,std::atomic<bool> *>(eventThread,doneAtomic);
-					threads.push_back(newPair);
+		if(EventJournal::isRecording() && listenerDepth == 0) { // Events of listeners come back on replay when their listener runs again
+			EventJournal::getInstance()->record(journalSource, eventType, arg);
+		}
+		if(EventBus::isPublished(eventType)) {
+			EventBus::getInstance()->write(eventType, arg);
+		}
+
+		// The loaded table stays alive and unchanged until we drop it, even if listeners are added or removed meanwhile
+		std::shared_ptr<const ListenerTable> table = std::atomic_load(&handlers);
+		if(eventType < table->size() && !(*table)[eventType].listeners.empty()) {
+			const EventEntry & entry = (*table)[eventType];
+			EventPriority priority = EventTypes::getPriority(eventType);
+			for(const Listener & l : entry.listeners) {
+				if(l.handler == nullptr) { // Typed listeners only take typed triggers, or replayed ones they can convert
+					if(replay && l.dispatchReplay != nullptr) {
+						inFlight++;
+						l.dispatchReplay(this, l, eventType, arg, priority, entry.gate);
+					}
+					continue;
 				}
-			}
-		}*/
-		if(handlers.count(eventType) > 0) {
-			std::vector<std::pair<unsigned long, void(*)(EventData *, std::atomic<bool> *)>> & methods = handlers[eventType];
-			for(std::pair<unsigned long, void(*)(EventData *, std::atomic<bool> *)> p : methods) {
-				std::atomic<bool> * doneAtomic = new std::atomic<bool>(false);
-				std::thread * eventThread = new std::thread(p.second, arg, doneAtomic);
-				std::pair<std::thread *,std::atomic<bool> *> * newPair = new std::pair<std::thread *,std::atomic<bool> *>(eventThread,doneAtomic);
-				threads.push_back(newPair);
+				if(l.coalesceWindow > 0) {
+					coalesce(l, eventType, data);
+					continue;
+				}
+				inFlight++;
+				dispatch(l, eventType, data, priority, entry.gate);
 			}
 		}
-		threadManipulationLock.unlock();
 	}
 }
 
-// The below function does not invalidate the event list, so it does not require locking
-unsigned long EventSource::addListener(std::string eventType, void(*handler)(EventData *, std::atomic<bool> *)) {
+void EventSource::triggerEvents(const std::string & eventType, EventData * arg) {
+	triggerEvents(EventTypes::intern(eventType), arg);
+}
+
+EventSource::ListenerTable * EventSource::copyHandlers(EventTypeID eventType) {
+	ListenerTable * table = new ListenerTable(*std::atomic_load(&handlers));
+	if(eventType >= table->size()) {
+		table->resize(eventType + 1);
+	}
+	return table;
+}
+
+void EventSource::publishHandlers(ListenerTable * table) {
+	std::atomic_store(&handlers, std::shared_ptr<const ListenerTable>(table));
+}
+
+unsigned long EventSource::addListener(EventTypeID eventType, void(*handler)(EventData *, std::atomic<bool> *), DispatchPolicy policy, unsigned int coalesceWindow) {
+	Listener l{};
+	l.handler = handler;
+	l.typedHandler = nullptr;
+	l.fromLegacy = nullptr;
+	l.dispatchReplay = nullptr;
+	l.policy = policy;
+	l.coalesceWindow = coalesceWindow;
+	return registerListener(eventType, l);
+}
+
+unsigned long EventSource::registerListener(EventTypeID eventType, Listener l) {
 	idLock.lock();
 	unsigned long id = nextID;
 	nextID++;
-
-	if(handlers.count(eventType) <= 0) {
-		std::vector<std::pair<unsigned long, void(*)(EventData *, std::atomic<bool> *)>> newVector;
-		newVector.push_back(std::pair<unsigned long, void(*)(EventData *, std::atomic<bool> *)>(id, handler));
-		handlers[eventType] = newVector;
-	}
-	else {
-		std::vector<std::pair<unsigned long, void(*)(EventData *, std::atomic<bool> *)>> & methods = handlers[eventType];
-		methods.push_back(std::pair<unsigned long, void(*)(EventData *, std::atomic<bool> *)>(id, handler));
+	idLock.unlock();
+	l.id = id;
+	if(l.policy == DispatchPolicy::SERIAL) {
+		l.strand.reset(new Strand());
 	}
 
-    idLock.unlock();
+	threadManipulationLock.lock();
+	ListenerTable * table = copyHandlers(eventType);
+	(*table)[eventType].listeners.push_back(l);
+	publishHandlers(table);
+	threadManipulationLock.unlock();
    	return id;
 }
 
-//This function does invalidate the event list, so it does require locking!
-void EventSource::clearListeners(std::string eventType) {
+unsigned long EventSource::addListener(const std::string & eventType, void(*handler)(EventData *, std::atomic<bool> *), DispatchPolicy policy, unsigned int coalesceWindow) {
+	return addListener(EventTypes::intern(eventType), handler, policy, coalesceWindow);
+}
+
+void EventSource::clearListeners(EventTypeID eventType) {
+	threadManipulationLock.lock();
+	ListenerTable * table = copyHandlers(eventType);
+	(*table)[eventType].listeners.clear();
+	publishHandlers(table);
+	threadManipulationLock.unlock();
+}
+
+void EventSource::clearListeners(const std::string & eventType) {
+	clearListeners(EventTypes::intern(eventType));
+}
+
+void EventSource::unsetListener(EventTypeID eventType, unsigned long id) {
 	threadManipulationLock.lock();
-	if(handlers.count(eventType) > 0) {
-		handlers.erase(eventType);
+	ListenerTable * table = copyHandlers(eventType);
+	std::vector<Listener> & methods = (*table)[eventType].listeners;
+	for(std::vector<Listener>::iterator i = methods.begin(); i != methods.end(); i++) {
+		if((*i).id == id) {
+			methods.erase(i);
+			break;
+		}
 	}
+	publishHandlers(table);
 	threadManipulationLock.unlock();
 }
 
-void EventSource::unsetListener(std::string eventType, unsigned long id) {
+void EventSource::unsetListener(const std::string & eventType, unsigned long id) {
+	unsetListener(EventTypes::intern(eventType), id);
+}
+
+unsigned long EventSource::listenerCount(EventTypeID eventType) {
+	std::shared_ptr<const ListenerTable> table = std::atomic_load(&handlers);
+	return eventType < table->size() ? (*table)[eventType].listeners.size() : 0;
+}
+
+unsigned long EventSource::listenerCount(const std::string & eventType) {
+	return listenerCount(EventTypes::intern(eventType));
+}
+
+void EventSource::setFlowControl(EventTypeID eventType, const FlowControl & limits) {
 	threadManipulationLock.lock();
-	if(handlers.count(eventType) > 0) {
-		std::vector<std::pair<unsigned long, void(*)(EventData *, std::atomic<bool> *)>> & methods = handlers[eventType];
-        for(std::vector<std::pair<unsigned long, void(*)(EventData *, std::atomic<bool> *)>>::iterator i = methods.begin(); i != methods.end(); i++) {
-			if((*i).first == id) {
-				methods.erase(i);
-				break;
-			}
-        }
+	ListenerTable * table = copyHandlers(eventType);
+	std::shared_ptr<FlowGate> old = (*table)[eventType].gate;
+	if(limits.maxInFlight == 0) {
+		(*table)[eventType].gate.reset();
+	}
+	else {
+		FlowGate * gate = new FlowGate(limits);
+		if(old) { // Carry the shedding counters over, running and queued stay with the old gate until its listeners are done
+			std::lock_guard<std::mutex> l(old->lock);
+			gate->counters.blocked = old->counters.blocked;
+			gate->counters.droppedOldest = old->counters.droppedOldest;
+			gate->counters.droppedNewest = old->counters.droppedNewest;
+			gate->counters.merged = old->counters.merged;
+		}
+		(*table)[eventType].gate.reset(gate);
 	}
+	publishHandlers(table);
 	threadManipulationLock.unlock();
 }
+
+void EventSource::setFlowControl(const std::string & eventType, const FlowControl & limits) {
+	setFlowControl(EventTypes::intern(eventType), limits);
+}
+
+FlowControl EventSource::getFlowControl(EventTypeID eventType) {
+	std::shared_ptr<const ListenerTable> table = std::atomic_load(&handlers);
+	if(eventType < table->size() && (*table)[eventType].gate) {
+		return (*table)[eventType].gate->limits;
+	}
+	return FlowControl();
+}
+
+FlowStatistics EventSource::getFlowStatistics(EventTypeID eventType) {
+	std::shared_ptr<const ListenerTable> table = std::atomic_load(&handlers);
+	FlowStatistics stats;
+	if(eventType < table->size() && (*table)[eventType].gate) {
+		FlowGate * gate = (*table)[eventType].gate.get();
+		std::lock_guard<std::mutex> l(gate->lock);
+		stats = gate->counters;
+		stats.queued = gate->waiting.size();
+	}
+	return stats;
+}
+
+std::string EventSource::describeFlowControl() {
+	std::shared_ptr<const ListenerTable> table = std::atomic_load(&handlers);
+	std::stringstream out;
+	for(EventTypeID type = 0; type < table->size(); type++) {
+		if(!(*table)[type].gate) {
+			continue;
+		}
+		FlowControl limits = (*table)[type].gate->limits;
+		FlowStatistics stats = getFlowStatistics(type);
+		out << EventTypes::getName(type) << ": " << stats.running << "/" << limits.maxInFlight << " in flight, "
+			<< stats.queued << "/" << limits.maxQueued << " queued, overflow " << FlowControl::getPolicyName(limits.overflow)
+			<< ", blocked " << stats.blocked << ", dropped oldest " << stats.droppedOldest
+			<< ", dropped newest " << stats.droppedNewest << ", merged " << stats.merged << "\n";
+	}
+	return out.str();
+}
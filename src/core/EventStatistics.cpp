@@ -0,0 +1,147 @@
+#include "EventStatistics.h"
+#include "EventDispatcher.h"
+
+#include <map>
+#include <sstream>
+#include <algorithm>
+
+std::mutex EventStatistics::shardsLock;
+std::vector<EventStatistics::Shard *> EventStatistics::shards;
+std::unordered_map<EventStatistics::Key, EventStatistics::Counters> EventStatistics::retired;
+
+EventStatistics::Summary::Summary() : type(0), listener(0), triggered(0), finished(0), dropped(0), totalQueueMicros(0), maxQueueMicros(0)
+{
+
+}
+
+EventStatistics::Counters::Counters() : triggered(0), finished(0), dropped(0), totalQueueMicros(0), maxQueueMicros(0)
+{
+
+}
+
+void EventStatistics::Counters::merge(const Counters & other) {
+	triggered += other.triggered;
+	finished += other.finished;
+	dropped += other.dropped;
+	totalQueueMicros += other.totalQueueMicros;
+	maxQueueMicros = std::max(maxQueueMicros, other.maxQueueMicros);
+	runTime.merge(other.runTime);
+}
+
+EventStatistics::ShardOwner::ShardOwner() : shard(new Shard())
+{
+	shardsLock.lock();
+	shards.push_back(shard);
+	shardsLock.unlock();
+}
+
+EventStatistics::ShardOwner::~ShardOwner()
+{
+	shardsLock.lock();
+	shards.erase(std::remove(shards.begin(), shards.end(), shard), shards.end());
+	for(std::pair<const Key, Counters> & c : shard->counters) {
+		retired[c.first].merge(c.second);
+	}
+	shardsLock.unlock();
+	delete shard;
+}
+
+EventStatistics::Shard * EventStatistics::localShard() {
+	static thread_local ShardOwner owner;
+	return owner.shard;
+}
+
+EventStatistics::Key EventStatistics::makeKey(EventTypeID type, unsigned long listener) {
+	return ((Key) type << 32) | (listener & 0xFFFFFFFF);
+}
+
+void EventStatistics::recordTrigger(EventTypeID type, unsigned long listener) {
+	Shard * s = localShard();
+	s->lock.lock();
+	s->counters[makeKey(type, listener)].triggered++;
+	s->lock.unlock();
+}
+
+void EventStatistics::recordRun(EventTypeID type, unsigned long listener, unsigned long long queueMicros, unsigned long long runMicros) {
+	Shard * s = localShard();
+	s->lock.lock();
+	Counters & c = s->counters[makeKey(type, listener)];
+	c.finished++;
+	c.totalQueueMicros += queueMicros;
+	if(queueMicros > c.maxQueueMicros) {
+		c.maxQueueMicros = queueMicros;
+	}
+	c.runTime.record(runMicros);
+	s->lock.unlock();
+}
+
+void EventStatistics::recordDrop(EventTypeID type, unsigned long listener) {
+	Shard * s = localShard();
+	s->lock.lock();
+	s->counters[makeKey(type, listener)].dropped++;
+	s->lock.unlock();
+}
+
+void EventStatistics::collect(std::vector<Summary> & out) {
+	// Ordered so the report lists event types together
+	std::map<Key, Counters> merged;
+	shardsLock.lock();
+	for(std::pair<const Key, Counters> & c : retired) {
+		merged[c.first].merge(c.second);
+	}
+	for(Shard * s : shards) {
+		s->lock.lock();
+		for(std::pair<const Key, Counters> & c : s->counters) {
+			merged[c.first].merge(c.second);
+		}
+		s->lock.unlock();
+	}
+	shardsLock.unlock();
+
+	for(std::pair<const Key, Counters> & c : merged) {
+		Summary s;
+		s.type = c.first >> 32;
+		s.listener = c.first & 0xFFFFFFFF;
+		s.triggered = c.second.triggered;
+		s.finished = c.second.finished;
+		s.dropped = c.second.dropped;
+		s.totalQueueMicros = c.second.totalQueueMicros;
+		s.maxQueueMicros = c.second.maxQueueMicros;
+		s.runTime = c.second.runTime;
+		out.push_back(s);
+	}
+}
+
+std::string EventStatistics::report() {
+	std::vector<Summary> summaries;
+	collect(summaries);
+
+	std::ostringstream o;
+	if(summaries.empty()) {
+		o << "No events have been triggered yet" << std::endl;
+	}
+	for(Summary & s : summaries) {
+		o << EventTypes::getName(s.type) << " listener " << s.listener << ": ";
+		// Shards are read one after another, so a listener may show up as finished before it shows up as triggered
+		unsigned long long done = s.finished + s.dropped;
+		o << "triggered " << s.triggered << ", in flight " << (s.triggered > done ? s.triggered - done : 0);
+		if(s.dropped > 0) {
+			o << ", dropped " << s.dropped;
+		}
+		if(s.finished > 0) {
+			o << ", queued avg " << LatencyHistogram::formatMicros(s.totalQueueMicros / s.finished);
+			o << " max " << LatencyHistogram::formatMicros(s.maxQueueMicros);
+			o << ", ran p50 " << LatencyHistogram::formatMicros(s.runTime.percentile(50));
+			o << " p99 " << LatencyHistogram::formatMicros(s.runTime.percentile(99));
+			o << " max " << LatencyHistogram::formatMicros(s.runTime.max());
+		}
+		o << std::endl;
+	}
+
+	EventDispatcher * d = EventDispatcher::getInstance();
+	o << "Dispatcher: " << EventDispatcher::getWorkerCount() << " workers, " << d->queuedCount() << " queued, " << d->dedicatedCount() << " dedicated threads";
+	o << ", deadline misses realtime " << d->getDeadlineMisses(EventPriority::REALTIME);
+	o << " interactive " << d->getDeadlineMisses(EventPriority::INTERACTIVE);
+	o << " background " << d->getDeadlineMisses(EventPriority::BACKGROUND) << std::endl;
+	return o.str();
+}
@@ -0,0 +1,137 @@
+#include "EventTypes.h"
+
+std::mutex EventTypes::lock;
+std::unordered_map<std::string, EventTypeID> EventTypes::ids;
+std::vector<std::string> EventTypes::names;
+std::vector<EventPriority> EventTypes::customPriorities;
+
+// Must be kept in the same order as BuiltinEventType
+const EventPriority EventTypes::builtinPriorities[BUILTIN_EVENT_TYPE_COUNT] = {
+	EventPriority::REALTIME, // ONINPUT
+	EventPriority::INTERACTIVE, // ONOUTPUT
+	EventPriority::INTERACTIVE, // ONCONVERSATIONSTART
+	EventPriority::INTERACTIVE, // ONCONVERSATIONEND
+	EventPriority::INTERACTIVE, // ONENTERPROMPT
+	EventPriority::INTERACTIVE, // ONEXITPROMPT
+	EventPriority::BACKGROUND, // ONMODEREGISTER
+	EventPriority::BACKGROUND, // ONMODEENABLE
+	EventPriority::BACKGROUND, // ONMODEDISABLE
+	EventPriority::BACKGROUND, // ONMODESTART
+	EventPriority::BACKGROUND, // ONMODESTOP
+	EventPriority::BACKGROUND, // ONSERVICEREGISTER
+	EventPriority::BACKGROUND, // ONSERVICEENABLE
+	EventPriority::BACKGROUND, // ONSERVICEDISABLE
+	EventPriority::BACKGROUND, // ONSERVICESTOP
+	EventPriority::BACKGROUND, // ONSERVICESTART
+	EventPriority::BACKGROUND, // ONFINISHINIT
+	EventPriority::REALTIME, // ON_START_SPEECH
+	EventPriority::REALTIME, // ON_END_SPEECH
+	EventPriority::REALTIME, // ON_HYPOTHESIS
+	EventPriority::INTERACTIVE, // ON_PAUSE
+	EventPriority::INTERACTIVE, // ON_RESUME
+	EventPriority::BACKGROUND, // ON_READY
+	EventPriority::BACKGROUND, // ON_SERVICE_READY
+	EventPriority::INTERACTIVE, // ON_SPEECH_START
+	EventPriority::INTERACTIVE, // ON_SPEECH_END
+	EventPriority::INTERACTIVE, // ON_MIMIC_AUDIO_PREPARED
+	EventPriority::INTERACTIVE // ASYNC_SPEECH_REQUEST
+};
+
+void EventTypes::registerBuiltins() {
+	if(!names.empty()) {
+		return;
+	}
+
+	// Must be kept in the same order as BuiltinEventType
+	static const char * builtins[BUILTIN_EVENT_TYPE_COUNT] = {
+		ONINPUT,
+		ONOUTPUT,
+		ONCONVERSATIONSTART,
+		ONCONVERSATIONEND,
+		ONENTERPROMPT,
+		ONEXITPROMPT,
+		ONMODEREGISTER,
+		ONMODEENABLE,
+		ONMODEDISABLE,
+		ONMODESTART,
+		ONMODESTOP,
+		ONSERVICEREGISTER,
+		ONSERVICEENABLE,
+		ONSERVICEDISABLE,
+		ONSERVICESTOP,
+		ONSERVICESTART,
+		ONFINISHINIT,
+		ON_START_SPEECH,
+		ON_END_SPEECH,
+		ON_HYPOTHESIS,
+		ON_PAUSE,
+		ON_RESUME,
+		ON_READY,
+		ON_SERVICE_READY,
+		ON_SPEECH_START,
+		ON_SPEECH_END,
+		ON_MIMIC_AUDIO_PREPARED,
+		ASYNC_SPEECH_REQUEST
+	};
+
+	names.reserve(BUILTIN_EVENT_TYPE_COUNT);
+	for(EventTypeID i = 0; i < BUILTIN_EVENT_TYPE_COUNT; i++) {
+		names.push_back(builtins[i]);
+		ids[names.back()] = i;
+	}
+}
+
+EventTypeID EventTypes::intern(const std::string & name) {
+	std::lock_guard<std::mutex> l(lock);
+	registerBuiltins();
+	std::unordered_map<std::string, EventTypeID>::iterator i = ids.find(name);
+	if(i != ids.end()) {
+		return i->second;
+	}
+
+	EventTypeID id = names.size();
+	names.push_back(name);
+	ids[name] = id;
+	customPriorities.push_back(EventPriority::INTERACTIVE);
+	return id;
+}
+
+std::string EventTypes::getName(EventTypeID id) {
+	std::lock_guard<std::mutex> l(lock);
+	registerBuiltins();
+	if(id < names.size()) {
+		return names[id];
+	}
+	return "";
+}
+
+EventTypeID EventTypes::count() {
+	std::lock_guard<std::mutex> l(lock);
+	registerBuiltins();
+	return names.size();
+}
+
+EventPriority EventTypes::getPriority(EventTypeID id) {
+	if(id < BUILTIN_EVENT_TYPE_COUNT) {
+		return builtinPriorities[id];
+	}
+
+	std::lock_guard<std::mutex> l(lock);
+	if(id - BUILTIN_EVENT_TYPE_COUNT < customPriorities.size()) {
+		return customPriorities[id - BUILTIN_EVENT_TYPE_COUNT];
+	}
+	return EventPriority::INTERACTIVE;
+}
+
+bool EventTypes::setPriority(EventTypeID id, EventPriority priority) {
+	if(id < BUILTIN_EVENT_TYPE_COUNT) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> l(lock);
+	if(id - BUILTIN_EVENT_TYPE_COUNT < customPriorities.size()) {
+		customPriorities[id - BUILTIN_EVENT_TYPE_COUNT] = priority;
+		return true;
+	}
+	return false;
+}
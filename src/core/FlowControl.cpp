@@ -0,0 +1,34 @@
+#include "FlowControl.h"
+
+std::string FlowControl::getPolicyName(OverflowPolicy policy) {
+	switch(policy) {
+		case OverflowPolicy::BLOCK:
+			return "block";
+		case OverflowPolicy::DROP_OLDEST:
+			return "drop-oldest";
+		case OverflowPolicy::DROP_NEWEST:
+			return "drop-newest";
+		case OverflowPolicy::MERGE:
+			return "merge";
+	}
+	return "";
+}
+
+bool FlowControl::parsePolicy(const std::string & name, OverflowPolicy & policy) {
+	if(name == "block") {
+		policy = OverflowPolicy::BLOCK;
+	}
+	else if(name == "drop-oldest") {
+		policy = OverflowPolicy::DROP_OLDEST;
+	}
+	else if(name == "drop-newest") {
+		policy = OverflowPolicy::DROP_NEWEST;
+	}
+	else if(name == "merge") {
+		policy = OverflowPolicy::MERGE;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
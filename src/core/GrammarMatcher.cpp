@@ -0,0 +1,394 @@
+#include "GrammarMatcher.h"
+#include "DynamicGrammar.h"
+
+#include <cctype>
+#include <algorithm>
+
+///Word ID of <VOID>, which no word has
+#define VOID_WORD -2
+
+GrammarMatcher::GrammarMatcher() : compiles(0)
+{
+
+}
+
+void GrammarMatcher::setPrefix(const std::string & words) {
+	prefix.clear();
+	for(const std::string & w : splitWords(words)) {
+		prefix.push_back(internWord(w));
+	}
+}
+
+bool GrammarMatcher::compileMode(const std::string & mode, Grammar & root, const DynamicGrammar * source, Mode * handle) {
+	Program p;
+	p.mode = mode;
+	p.handle = handle;
+	p.source = source;
+	p.generation = source == nullptr ? 0 : source->getGeneration();
+	p.matchesEmpty = false;
+
+	std::vector<std::string> rules;
+	std::shared_ptr<Rule> r = root.getRule(mode);
+	p.compiled = r != nullptr && compile(r->getRuleExpansion().get(), root, p.code, rules);
+	if(p.compiled) {
+		Instruction match = {Op::MATCH, 0, 0};
+		p.code.push_back(match);
+		findFirstWords(p);
+	}
+	else {
+		p.code.clear();
+	}
+	compiles++;
+
+	std::vector<Program>::iterator existing = std::find_if(programs.begin(), programs.end(), [&mode](const Program & o) { return o.mode == mode; });
+	if(existing != programs.end()) {
+		*existing = p;
+	}
+	else {
+		programs.push_back(p);
+	}
+	rebuildIndex();
+	return p.compiled;
+}
+
+void GrammarMatcher::removeMode(const std::string & mode) {
+	std::vector<Program>::iterator existing = std::find_if(programs.begin(), programs.end(), [&mode](const Program & o) { return o.mode == mode; });
+	if(existing != programs.end()) {
+		programs.erase(existing);
+		rebuildIndex();
+	}
+}
+
+unsigned int GrammarMatcher::refresh(Grammar & root) {
+	unsigned int recompiled = 0;
+	for(unsigned int i = 0; i < programs.size(); i++) {
+		if(programs[i].source != nullptr && programs[i].source->getGeneration() != programs[i].generation) {
+			std::string mode = programs[i].mode;
+			compileMode(mode, root, programs[i].source, programs[i].handle);
+			recompiled++;
+		}
+	}
+	return recompiled;
+}
+
+bool GrammarMatcher::isComplete() const {
+	for(const Program & p : programs) {
+		if(!p.compiled) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool GrammarMatcher::compile(const Expansion * e, Grammar & root, std::vector<Instruction> & code, std::vector<std::string> & rules) {
+	if(e == nullptr) {
+		return false;
+	}
+
+	switch(e->getType()) {
+		case TOKEN: {
+			std::string text = e->getText();
+			text.erase(std::remove(text.begin(), text.end(), '"'), text.end()); // Quoted tokens
+			for(const std::string & w : splitWords(text)) {
+				Instruction i = {Op::WORD, internWord(w), 0};
+				code.push_back(i);
+			}
+			return true;
+		}
+		case SEQUENCE:
+		case REQUIRED_GROUPING:
+			for(unsigned int c = 0; c < e->childCount(); c++) {
+				if(!compile(e->getChild(c).get(), root, code, rules)) {
+					return false;
+				}
+			}
+			return true;
+		case ALTERNATE_SET: {
+			// SPLIT to each alternative in turn, every alternative JUMPs past the rest when done
+			std::vector<std::size_t> jumps;
+			unsigned int count = e->childCount();
+			for(unsigned int c = 0; c < count; c++) {
+				std::size_t split = code.size();
+				if(c + 1 < count) {
+					Instruction i = {Op::SPLIT, (int) split + 1, 0};
+					code.push_back(i);
+				}
+				if(!compile(e->getChild(c).get(), root, code, rules)) {
+					return false;
+				}
+				if(c + 1 < count) {
+					jumps.push_back(code.size());
+					Instruction j = {Op::JUMP, 0, 0};
+					code.push_back(j);
+					code[split].y = code.size();
+				}
+			}
+			for(std::size_t j : jumps) {
+				code[j].x = code.size();
+			}
+			return true;
+		}
+		case OPTIONAL_GROUPING: {
+			std::size_t split = code.size();
+			Instruction i = {Op::SPLIT, (int) split + 1, 0};
+			code.push_back(i);
+			if(!compile(e->getChild(0).get(), root, code, rules)) {
+				return false;
+			}
+			code[split].y = code.size();
+			return true;
+		}
+		case KLEENE_STAR: {
+			std::size_t split = code.size();
+			Instruction i = {Op::SPLIT, (int) split + 1, 0};
+			code.push_back(i);
+			if(!compile(e->getChild(0).get(), root, code, rules)) {
+				return false;
+			}
+			Instruction j = {Op::JUMP, (int) split, 0};
+			code.push_back(j);
+			code[split].y = code.size();
+			return true;
+		}
+		case PLUS_OPERATOR: {
+			std::size_t start = code.size();
+			if(!compile(e->getChild(0).get(), root, code, rules)) {
+				return false;
+			}
+			Instruction i = {Op::SPLIT, (int) start, (int) code.size() + 1};
+			code.push_back(i);
+			return true;
+		}
+		case TAG: {
+			for(const std::string & t : ((const Tag *) e)->getTags()) {
+				Instruction i = {Op::TAG, internTag(t), 0};
+				code.push_back(i);
+			}
+			return compile(e->getChild(0).get(), root, code, rules);
+		}
+		case RULE_REFERENCE: {
+			std::string name = ((const RuleReference *) e)->getRuleName();
+			if(name == "NULL") {
+				return true;
+			}
+			if(name == "VOID") {
+				Instruction i = {Op::WORD, VOID_WORD, 0};
+				code.push_back(i);
+				return true;
+			}
+			if(std::find(rules.begin(), rules.end(), name) != rules.end()) { // Recursive, a finite automaton can not hold it
+				return false;
+			}
+			std::shared_ptr<Rule> r = root.getRule(name);
+			if(r == nullptr) {
+				return false;
+			}
+			rules.push_back(name);
+			bool compiled = compile(r->getRuleExpansion().get(), root, code, rules);
+			rules.pop_back();
+			return compiled;
+		}
+		default:
+			return false;
+	}
+}
+
+void GrammarMatcher::findFirstWords(Program & p) const {
+	std::vector<std::pair<int, int>> threads;
+	std::vector<unsigned int> seen(p.code.size(), 0);
+	std::vector<std::pair<int, int>> tagHistory;
+	addThread(p, threads, 0, -1, seen, 1, tagHistory);
+
+	p.firstWords.clear();
+	p.matchesEmpty = false;
+	for(const std::pair<int, int> & t : threads) {
+		const Instruction & i = p.code[t.first];
+		if(i.op == Op::MATCH) {
+			p.matchesEmpty = true;
+		}
+		else if(i.x != VOID_WORD && std::find(p.firstWords.begin(), p.firstWords.end(), i.x) == p.firstWords.end()) {
+			p.firstWords.push_back(i.x);
+		}
+	}
+}
+
+void GrammarMatcher::rebuildIndex() {
+	firstIndex.clear();
+	emptyPrograms.clear();
+	for(unsigned int i = 0; i < programs.size(); i++) {
+		for(int w : programs[i].firstWords) {
+			firstIndex[w].push_back(i);
+		}
+		if(programs[i].matchesEmpty) {
+			emptyPrograms.push_back(i);
+		}
+	}
+}
+
+void GrammarMatcher::addThread(const Program & p, std::vector<std::pair<int, int>> & list, int pc, int history, std::vector<unsigned int> & seen, unsigned int stamp, std::vector<std::pair<int, int>> & tagHistory) const {
+	// Depth first with an explicit stack, the preferred branch of a SPLIT is pushed last so it is followed first
+	std::vector<std::pair<int, int>> stack;
+	stack.push_back(std::make_pair(pc, history));
+	while(!stack.empty()) {
+		pc = stack.back().first;
+		history = stack.back().second;
+		stack.pop_back();
+		if(seen[pc] == stamp) { // A higher priority thread already got here
+			continue;
+		}
+		seen[pc] = stamp;
+
+		const Instruction & i = p.code[pc];
+		switch(i.op) {
+			case Op::JUMP:
+				stack.push_back(std::make_pair(i.x, history));
+				break;
+			case Op::SPLIT:
+				stack.push_back(std::make_pair(i.y, history));
+				stack.push_back(std::make_pair(i.x, history));
+				break;
+			case Op::TAG:
+				tagHistory.push_back(std::make_pair(i.x, history));
+				stack.push_back(std::make_pair(pc + 1, (int) tagHistory.size() - 1));
+				break;
+			default:
+				list.push_back(std::make_pair(pc, history));
+				break;
+		}
+	}
+}
+
+bool GrammarMatcher::run(const Program & p, const std::vector<int> & words, std::vector<std::string> & tags) const {
+	// Threads are (pc, index of their newest tag in tagHistory), kept in priority order
+	std::vector<std::pair<int, int>> current;
+	std::vector<std::pair<int, int>> next;
+	std::vector<std::pair<int, int>> tagHistory;
+	std::vector<unsigned int> seen(p.code.size(), 0);
+	unsigned int stamp = 1;
+
+	addThread(p, current, 0, -1, seen, stamp, tagHistory);
+	for(int w : words) {
+		stamp++;
+		next.clear();
+		for(const std::pair<int, int> & t : current) {
+			const Instruction & i = p.code[t.first];
+			if(i.op == Op::WORD && i.x == w) {
+				addThread(p, next, t.first + 1, t.second, seen, stamp, tagHistory);
+			}
+		}
+		current.swap(next);
+		if(current.empty()) {
+			return false;
+		}
+	}
+
+	for(const std::pair<int, int> & t : current) {
+		if(p.code[t.first].op == Op::MATCH) {
+			tags.clear();
+			for(int h = t.second; h >= 0; h = tagHistory[h].second) {
+				tags.push_back(tagNames[tagHistory[h].first]);
+			}
+			std::reverse(tags.begin(), tags.end());
+			return true;
+		}
+	}
+	return false;
+}
+
+GrammarMatch GrammarMatcher::match(const std::string & command) const {
+	GrammarMatch result;
+	std::vector<std::string> split = splitWords(command);
+	if(split.size() < prefix.size()) {
+		return result;
+	}
+
+	std::vector<int> words;
+	for(unsigned int i = 0; i < split.size(); i++) {
+		std::unordered_map<std::string, int>::const_iterator id = wordIDs.find(split[i]);
+		if(id == wordIDs.end()) { // No rule has this word
+			return result;
+		}
+		if(i < prefix.size()) {
+			if(id->second != prefix[i]) {
+				return result;
+			}
+		}
+		else {
+			words.push_back(id->second);
+		}
+	}
+
+	const std::vector<int> * candidates = &emptyPrograms;
+	if(!words.empty()) {
+		std::unordered_map<int, std::vector<int>>::const_iterator c = firstIndex.find(words[0]);
+		if(c == firstIndex.end()) {
+			return result;
+		}
+		candidates = &c->second;
+	}
+	for(int c : *candidates) {
+		if(run(programs[c], words, result.tags)) {
+			result.matches = true;
+			result.mode = programs[c].mode;
+			result.handle = programs[c].handle;
+			return result;
+		}
+	}
+	return result;
+}
+
+unsigned long long GrammarMatcher::getCompileCount() const {
+	return compiles;
+}
+
+std::size_t GrammarMatcher::getModeCount() const {
+	return programs.size();
+}
+
+std::size_t GrammarMatcher::getInstructionCount() const {
+	std::size_t count = 0;
+	for(const Program & p : programs) {
+		count += p.code.size();
+	}
+	return count;
+}
+
+int GrammarMatcher::internWord(const std::string & word) {
+	std::unordered_map<std::string, int>::iterator i = wordIDs.find(word);
+	if(i != wordIDs.end()) {
+		return i->second;
+	}
+	int id = wordIDs.size();
+	wordIDs[word] = id;
+	return id;
+}
+
+int GrammarMatcher::internTag(const std::string & tag) {
+	std::unordered_map<std::string, int>::iterator i = tagIDs.find(tag);
+	if(i != tagIDs.end()) {
+		return i->second;
+	}
+	tagIDs[tag] = tagNames.size();
+	tagNames.push_back(tag);
+	return tagNames.size() - 1;
+}
+
+std::vector<std::string> GrammarMatcher::splitWords(const std::string & text) {
+	std::vector<std::string> words;
+	std::string word;
+	for(char c : text) {
+		if(std::isspace((unsigned char) c)) {
+			if(!word.empty()) {
+				words.push_back(word);
+				word.clear();
+			}
+		}
+		else {
+			word += std::tolower((unsigned char) c);
+		}
+	}
+	if(!word.empty()) {
+		words.push_back(word);
+	}
+	return words;
+}
@@ -0,0 +1,220 @@
+#include "InputPipeline.h"
+#include "filters/TextFilter.h"
+
+#include <cctype>
+#include <sstream>
+
+InputPipeline::InputPipeline(StageFunction match, StageFunction dedup, StageFunction dispatch) : detached(false), running(false)
+{
+	for(unsigned int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+		stages[i].type = (PipelineStageType) i;
+	}
+	stages[(int) PipelineStageType::NORMALIZE].function = [](PipelineCommand & c) {
+		c.text = normalize(c.text);
+		return !c.text.empty();
+	};
+	stages[(int) PipelineStageType::FILTER].function = std::bind(&InputPipeline::filter, this, std::placeholders::_1);
+	stages[(int) PipelineStageType::MATCH].function = match;
+	stages[(int) PipelineStageType::DEDUP].function = dedup;
+	stages[(int) PipelineStageType::DISPATCH].function = dispatch;
+}
+
+InputPipeline::~InputPipeline()
+{
+	stop();
+	if(!detached) { // A detached worker may still come back to its queue
+		for(Stage & s : stages) {
+			delete s.queue;
+		}
+	}
+	for(TextFilter * f : filters) {
+		delete f;
+	}
+}
+
+void InputPipeline::setStageConfig(PipelineStageType stage, const PipelineStageConfig & config) {
+	std::lock_guard<std::mutex> l(stateLock);
+	if(!running.load()) {
+		stages[(int) stage].config = config;
+		if(stages[(int) stage].config.workers == 0) {
+			stages[(int) stage].config.workers = 1;
+		}
+	}
+}
+
+void InputPipeline::addFilter(TextFilter * filter) {
+	std::lock_guard<std::mutex> l(stateLock);
+	if(!running.load()) {
+		filters.push_back(filter);
+	}
+}
+
+void InputPipeline::start() {
+	std::lock_guard<std::mutex> l(stateLock);
+	if(running.load()) {
+		return;
+	}
+	for(Stage & s : stages) {
+		delete s.queue;
+		s.queue = new BlockingQueue<PipelineCommand>(s.config.queue);
+	}
+	running.store(true);
+	for(Stage & s : stages) {
+		for(unsigned int i = 0; i < s.config.workers; i++) {
+			s.workers.push_back(std::thread(runWorker, this, &s));
+		}
+	}
+}
+
+void InputPipeline::stop() {
+	std::lock_guard<std::mutex> l(stateLock);
+	if(!running.load()) {
+		return;
+	}
+	running.store(false);
+	for(Stage & s : stages) {
+		s.queue->close();
+	}
+	for(Stage & s : stages) {
+		for(std::thread & t : s.workers) {
+			if(t.get_id() == std::this_thread::get_id()) { // Stopped from inside a Mode, this worker returns on its own once the Mode does
+				t.detach();
+				detached = true;
+			}
+			else {
+				t.join();
+			}
+		}
+		s.workers.clear();
+	}
+	if(!detached) { // Let whoever is waiting on the commands that were still queued know they will not be dispatched
+		PipelineCommand c;
+		for(Stage & s : stages) {
+			while(s.queue->tryPop(c)) {
+				finish(c, false);
+			}
+		}
+	}
+}
+
+bool InputPipeline::submit(const std::string & command, const std::string & source, const std::function<void(const PipelineCommand &, bool)> & done) {
+	if(!running.load()) {
+		return false;
+	}
+	PipelineCommand c;
+	c.input = command;
+	c.text = command;
+	c.source = source;
+	c.done = done;
+	c.submitted = std::chrono::steady_clock::now();
+	c.queued = c.submitted;
+	return stages[(int) PipelineStageType::NORMALIZE].queue->push(c);
+}
+
+void InputPipeline::runWorker(InputPipeline * p, Stage * s) {
+	Stage * next = s->type == PipelineStageType::DISPATCH ? nullptr : &p->stages[(int) s->type + 1];
+	PipelineCommand c;
+	while(s->queue->pop(c)) {
+		if(!p->running.load()) { // Stopping, leave the rest of the queue
+			finish(c, false);
+			break;
+		}
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		bool passed = s->function(c);
+		std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+
+		s->statisticsLock.lock();
+		s->waited.record(std::chrono::duration_cast<std::chrono::microseconds>(start - c.queued).count());
+		s->ran.record(std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count());
+		if(passed) {
+			s->processed++;
+			if(next == nullptr) {
+				p->total.record(std::chrono::duration_cast<std::chrono::microseconds>(stop - c.submitted).count());
+			}
+		}
+		else {
+			s->dropped++;
+		}
+		s->statisticsLock.unlock();
+
+		if(passed && next != nullptr) {
+			c.queued = stop;
+			if(!next->queue->push(c)) { // Waits here while the next stage is full, fails once the pipeline stops
+				finish(c, false);
+			}
+		}
+		else {
+			finish(c, passed);
+		}
+	}
+}
+
+void InputPipeline::finish(const PipelineCommand & command, bool dispatched) {
+	if(command.done) {
+		command.done(command, dispatched);
+	}
+}
+
+bool InputPipeline::filter(PipelineCommand & command) {
+	for(TextFilter * f : filters) {
+		command.text = f->filterText(command.text);
+	}
+	return !command.text.empty();
+}
+
+std::string InputPipeline::normalize(const std::string & command) {
+	std::string out;
+	bool space = false;
+	for(char c : command) {
+		if(std::isalnum((unsigned char) c) || c == '\'' || c == '-') {
+			if(space && !out.empty()) {
+				out += ' ';
+			}
+			out += std::tolower((unsigned char) c);
+			space = false;
+		}
+		else {
+			space = true;
+		}
+	}
+	return out;
+}
+
+std::string InputPipeline::getStageName(PipelineStageType stage) {
+	switch(stage) {
+		case PipelineStageType::NORMALIZE:
+			return "normalize";
+		case PipelineStageType::FILTER:
+			return "filter";
+		case PipelineStageType::MATCH:
+			return "match";
+		case PipelineStageType::DEDUP:
+			return "dedup";
+		case PipelineStageType::DISPATCH:
+			return "dispatch";
+	}
+	return "";
+}
+
+std::string InputPipeline::report() {
+	std::lock_guard<std::mutex> l(stateLock);
+	std::ostringstream out;
+	for(Stage & s : stages) {
+		std::size_t depth = s.queue == nullptr ? 0 : s.queue->size();
+		unsigned long long fullWaits = s.queue == nullptr ? 0 : s.queue->getFullWaits();
+		std::lock_guard<std::mutex> sl(s.statisticsLock);
+		out << "  " << getStageName(s.type) << ": " << s.config.workers << " workers, queue " << depth << "/" << s.config.queue
+			<< ", " << s.processed << " passed, " << s.dropped << " dropped, " << fullWaits << " waits on a full queue";
+		if(s.waited.count() > 0) {
+			out << ", queued p50 " << LatencyHistogram::formatMicros(s.waited.percentile(50)) << " p99 " << LatencyHistogram::formatMicros(s.waited.percentile(99))
+				<< ", ran p50 " << LatencyHistogram::formatMicros(s.ran.percentile(50)) << " p99 " << LatencyHistogram::formatMicros(s.ran.percentile(99));
+		}
+		out << "\n";
+	}
+	std::lock_guard<std::mutex> dl(stages[(int) PipelineStageType::DISPATCH].statisticsLock);
+	if(total.count() > 0) {
+		out << "  end to end: p50 " << LatencyHistogram::formatMicros(total.percentile(50)) << " p99 " << LatencyHistogram::formatMicros(total.percentile(99))
+			<< " max " << LatencyHistogram::formatMicros(total.max()) << "\n";
+	}
+	return out.str();
+}
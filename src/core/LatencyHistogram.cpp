@@ -0,0 +1,95 @@
+#include "LatencyHistogram.h"
+
+#include <cstdio>
+
+LatencyHistogram::LatencyHistogram() : total(0), longest(0)
+{
+	for(unsigned int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+		buckets[i] = 0;
+	}
+}
+
+unsigned int LatencyHistogram::bucketOf(unsigned long long micros) {
+	if(micros < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+		return micros;
+	}
+
+	unsigned int exponent = 63 - __builtin_clzll(micros);
+	if(exponent >= LATENCY_HISTOGRAM_EXPONENTS) {
+		return LATENCY_HISTOGRAM_BUCKETS - 1;
+	}
+	// The three bits below the highest set bit pick the sub-bucket
+	unsigned int sub = (micros >> (exponent - 3)) & (LATENCY_HISTOGRAM_SUB_BUCKETS - 1);
+	return (exponent - 2) * LATENCY_HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+unsigned long long LatencyHistogram::upperBoundOf(unsigned int bucket) {
+	if(bucket < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+		return bucket;
+	}
+
+	unsigned int exponent = bucket / LATENCY_HISTOGRAM_SUB_BUCKETS + 2;
+	unsigned int sub = bucket % LATENCY_HISTOGRAM_SUB_BUCKETS;
+	unsigned long long width = 1ULL << (exponent - 3);
+	return (LATENCY_HISTOGRAM_SUB_BUCKETS + sub) * width + width - 1;
+}
+
+void LatencyHistogram::record(unsigned long long micros) {
+	buckets[bucketOf(micros)]++;
+	total++;
+	if(micros > longest) {
+		longest = micros;
+	}
+}
+
+void LatencyHistogram::merge(const LatencyHistogram & other) {
+	for(unsigned int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+		buckets[i] += other.buckets[i];
+	}
+	total += other.total;
+	if(other.longest > longest) {
+		longest = other.longest;
+	}
+}
+
+unsigned long long LatencyHistogram::count() const {
+	return total;
+}
+
+unsigned long long LatencyHistogram::max() const {
+	return longest;
+}
+
+unsigned long long LatencyHistogram::percentile(double p) const {
+	if(total == 0) {
+		return 0;
+	}
+
+	unsigned long long wanted = (unsigned long long) (p / 100.0 * total);
+	if(wanted == 0) {
+		wanted = 1;
+	}
+	unsigned long long seen = 0;
+	for(unsigned int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+		seen += buckets[i];
+		if(seen >= wanted) {
+			unsigned long long bound = upperBoundOf(i);
+			return bound < longest ? bound : longest;
+		}
+	}
+	return longest;
+}
+
+std::string LatencyHistogram::formatMicros(unsigned long long micros) {
+	char buffer[32];
+	if(micros < 1000) {
+		snprintf(buffer, sizeof(buffer), "%lluus", micros);
+	}
+	else if(micros < 1000000) {
+		snprintf(buffer, sizeof(buffer), "%.1fms", micros / 1000.0);
+	}
+	else {
+		snprintf(buffer, sizeof(buffer), "%.1fs", micros / 1000000.0);
+	}
+	return buffer;
+}
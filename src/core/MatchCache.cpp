@@ -0,0 +1,86 @@
+#include "MatchCache.h"
+
+MatchCache::MatchCache(std::size_t capacity) : capacity(capacity), generation(0), hits(0), misses(0), invalidations(0)
+{
+
+}
+
+void MatchCache::setCapacity(std::size_t c) {
+	cacheLock.lock();
+	capacity = c;
+	trim();
+	cacheLock.unlock();
+}
+
+std::size_t MatchCache::getCapacity() {
+	std::lock_guard<std::mutex> lock(cacheLock);
+	return capacity;
+}
+
+bool MatchCache::lookup(const std::string & command, unsigned long g, GrammarMatch & result) {
+	std::lock_guard<std::mutex> lock(cacheLock);
+	if(capacity == 0) {
+		return false;
+	}
+	if(!moveToGeneration(g)) { // Looked up under a grammar that was already replaced
+		misses++;
+		return false;
+	}
+
+	std::unordered_map<std::string, EntryList::iterator>::iterator i = index.find(command);
+	if(i == index.end()) {
+		misses++;
+		return false;
+	}
+	entries.splice(entries.begin(), entries, i->second); // Now the most recently used
+	result = i->second->second;
+	hits++;
+	return true;
+}
+
+void MatchCache::store(const std::string & command, unsigned long g, const GrammarMatch & result) {
+	std::lock_guard<std::mutex> lock(cacheLock);
+	if(capacity == 0 || !result.matches || !moveToGeneration(g)) {
+		return;
+	}
+
+	std::unordered_map<std::string, EntryList::iterator>::iterator i = index.find(command);
+	if(i != index.end()) { // Another worker matched the same command at the same time
+		i->second->second = result;
+		entries.splice(entries.begin(), entries, i->second);
+		return;
+	}
+	entries.push_front(std::make_pair(command, result));
+	index[command] = entries.begin();
+	trim();
+}
+
+std::string MatchCache::report() {
+	std::lock_guard<std::mutex> lock(cacheLock);
+	unsigned long long lookups = hits + misses;
+	std::string rate = lookups == 0 ? "0" : std::to_string(hits * 100 / lookups);
+	return std::to_string(entries.size()) + "/" + std::to_string(capacity) + " cached, " + std::to_string(hits) + " hits, " + std::to_string(misses) + " misses ("
+		+ rate + "% hit rate), " + std::to_string(invalidations) + " invalidations, generation " + std::to_string(generation);
+}
+
+bool MatchCache::moveToGeneration(unsigned long g) {
+	if(g < generation) {
+		return false;
+	}
+	if(g > generation) {
+		if(!entries.empty()) {
+			entries.clear();
+			index.clear();
+			invalidations++;
+		}
+		generation = g;
+	}
+	return true;
+}
+
+void MatchCache::trim() {
+	while(entries.size() > capacity) {
+		index.erase(entries.back().first);
+		entries.pop_back();
+	}
+}
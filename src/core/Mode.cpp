@@ -1,7 +1,7 @@
 #include "Mode.h"
 #include "Buckey.h"
 
-Mode::Mode()
+Mode::Mode() : repeatWindow(0)
 {
 	state = ModeState::NOT_LOADED;
 }
@@ -22,11 +22,16 @@ void Mode::setAssetsDir(cppfs::FileHandle aDir) {
 	assetsDir = aDir;
 }
 
-std::string Mode::getName() const
+const std::string & Mode::getName() const
 {
 	return name;
 }
 
+unsigned int Mode::getRepeatWindow() const
+{
+	return repeatWindow;
+}
+
 Mode::~Mode()
 {
 
@@ -1,4 +1,5 @@
 #include "ModeControlEventData.h"
+#include "ObjectPool.h"
 
 ModeControlEventData::ModeControlEventData(Mode * m)
 {
@@ -13,3 +14,15 @@ ModeControlEventData::~ModeControlEventData()
 {
 	//dtor
 }
+
+void * ModeControlEventData::operator new(std::size_t size) {
+	return ObjectPool<ModeControlEventData>::allocate(size);
+}
+
+void ModeControlEventData::operator delete(void * p, std::size_t size) {
+	ObjectPool<ModeControlEventData>::release(p, size);
+}
+
+void ModeControlEventData::serialize(PayloadWriter & out) const {
+	out.writeString(mode == nullptr ? "" : mode->getName());
+}
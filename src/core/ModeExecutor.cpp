@@ -0,0 +1,101 @@
+#include "ModeExecutor.h"
+#include "Mode.h"
+
+#include <algorithm>
+
+thread_local ModeExecutor::CommandToken * ModeExecutor::current = nullptr;
+
+ModeExecutor::ModeExecutor(Mode * m, const ModeExecutorConfig & c) : mode(m), config(c), queue(c.queue), running(0), finished(0), cancelled(0), timedOut(0), dropped(0)
+{
+	if(config.concurrency == 0) {
+		config.concurrency = 1;
+	}
+	for(unsigned int i = 0; i < config.concurrency; i++) {
+		workers.push_back(std::thread(runWorker, this));
+	}
+}
+
+ModeExecutor::~ModeExecutor()
+{
+	cancel();
+	queue.close();
+	for(std::thread & t : workers) {
+		if(t.get_id() == std::this_thread::get_id()) { // Deleted by its own Mode, the worker is on its way out already
+			t.detach();
+		}
+		else {
+			t.join();
+		}
+	}
+}
+
+bool ModeExecutor::submit(const std::string & command, const std::vector<std::string> & tags) {
+	ModeCommand c;
+	c.command = command;
+	c.tags = tags;
+	c.token = std::make_shared<CommandToken>();
+	if(config.timeout > 0) {
+		c.token->hasDeadline = true;
+		c.token->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.timeout);
+	}
+
+	tokenLock.lock();
+	tokens.push_back(c.token);
+	tokenLock.unlock();
+	if(!queue.tryPush(c)) {
+		tokenLock.lock();
+		tokens.erase(std::find(tokens.begin(), tokens.end(), c.token));
+		tokenLock.unlock();
+		dropped++;
+		return false;
+	}
+	return true;
+}
+
+void ModeExecutor::cancel() {
+	std::lock_guard<std::mutex> l(tokenLock);
+	for(std::shared_ptr<CommandToken> & t : tokens) {
+		t->cancelled.store(true);
+	}
+}
+
+bool ModeExecutor::isCancelled() {
+	return current != nullptr && current->isCancelled();
+}
+
+void ModeExecutor::runWorker(ModeExecutor * e) {
+	ModeCommand c;
+	while(e->queue.pop(c)) {
+		if(!c.token->isCancelled()) {
+			e->running++;
+			current = c.token.get();
+			e->mode->input(c.command, c.tags);
+			current = nullptr;
+			e->running--;
+		}
+
+		if(c.token->cancelled.load()) {
+			e->cancelled++;
+		}
+		else if(c.token->isCancelled()) {
+			e->timedOut++;
+		}
+		else {
+			e->finished++;
+		}
+
+		e->tokenLock.lock();
+		e->tokens.erase(std::find(e->tokens.begin(), e->tokens.end(), c.token));
+		e->tokenLock.unlock();
+		c.token.reset();
+	}
+}
+
+std::string ModeExecutor::report() {
+	return std::to_string(running.load()) + "/" + std::to_string(config.concurrency) + " running, " + std::to_string(queue.size()) + "/" + std::to_string(config.queue) + " queued, "
+		+ std::to_string(finished.load()) + " finished, " + std::to_string(cancelled.load()) + " cancelled, " + std::to_string(timedOut.load()) + " timed out, " + std::to_string(dropped.load()) + " dropped";
+}
+
+const ModeExecutorConfig & ModeExecutor::getConfig() const {
+	return config;
+}
@@ -0,0 +1,18 @@
+#include "OutputEvent.h"
+#include "OutputEventData.h"
+
+static EventData * outputToEventData(const OutputMessage & output) {
+	return new OutputEventData(output.message, output.type);
+}
+
+static bool outputFromEventData(EventData * data, OutputMessage & output) {
+	OutputEventData * o = dynamic_cast<OutputEventData *>(data);
+	if(o == nullptr) {
+		return false;
+	}
+	output.message = o->getMessage();
+	output.type = o->getType();
+	return true;
+}
+
+const Event<OutputMessage> OutputEvent(ONOUTPUT_ID, outputToEventData, outputFromEventData);
@@ -1,4 +1,5 @@
 #include "OutputEventData.h"
+#include "ObjectPool.h"
 
 OutputEventData::OutputEventData(std::string message, ReplyType t)
 {
@@ -18,3 +19,22 @@ OutputEventData::~OutputEventData()
 {
 
 }
+
+void * OutputEventData::operator new(std::size_t size) {
+	return ObjectPool<OutputEventData>::allocate(size);
+}
+
+void OutputEventData::operator delete(void * p, std::size_t size) {
+	ObjectPool<OutputEventData>::release(p, size);
+}
+
+void OutputEventData::serialize(PayloadWriter & out) const {
+	out.writeString(m);
+	out.writeInt((int) replyType);
+}
+
+EventData * OutputEventData::deserialize(PayloadReader & in) {
+	std::string message = in.readString();
+	ReplyType type = (ReplyType) in.readInt();
+	return new OutputEventData(message, type);
+}
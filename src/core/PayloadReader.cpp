@@ -0,0 +1,68 @@
+#include "PayloadReader.h"
+
+PayloadReader::PayloadReader(const char * data, std::size_t size) : data(data), size(size), position(0), failed(false)
+{
+
+}
+
+bool PayloadReader::take(std::size_t count) {
+	if(failed || size - position < count) {
+		failed = true;
+		return false;
+	}
+	position += count;
+	return true;
+}
+
+uint8_t PayloadReader::readByte() {
+	if(!take(1)) {
+		return 0;
+	}
+	return (uint8_t) data[position - 1];
+}
+
+bool PayloadReader::readBool() {
+	return readByte() != 0;
+}
+
+int32_t PayloadReader::readInt() {
+	return (int32_t) readUInt32();
+}
+
+uint32_t PayloadReader::readUInt32() {
+	if(!take(4)) {
+		return 0;
+	}
+	uint32_t i = 0;
+	for(int b = 0; b < 4; b++) {
+		i |= ((uint32_t) (unsigned char) data[position - 4 + b]) << (8 * b);
+	}
+	return i;
+}
+
+uint64_t PayloadReader::readUInt64() {
+	if(!take(8)) {
+		return 0;
+	}
+	uint64_t i = 0;
+	for(int b = 0; b < 8; b++) {
+		i |= ((uint64_t) (unsigned char) data[position - 8 + b]) << (8 * b);
+	}
+	return i;
+}
+
+std::string PayloadReader::readString() {
+	uint32_t length = readUInt32();
+	if(!take(length)) {
+		return "";
+	}
+	return std::string(data + position - length, length);
+}
+
+bool PayloadReader::good() const {
+	return !failed;
+}
+
+bool PayloadReader::atEnd() const {
+	return position == size;
+}
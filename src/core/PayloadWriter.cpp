@@ -0,0 +1,35 @@
+#include "PayloadWriter.h"
+
+PayloadWriter::PayloadWriter(std::string & out) : out(out)
+{
+
+}
+
+void PayloadWriter::writeByte(uint8_t b) {
+	out.push_back((char) b);
+}
+
+void PayloadWriter::writeBool(bool b) {
+	out.push_back(b ? 1 : 0);
+}
+
+void PayloadWriter::writeInt(int32_t i) {
+	writeUInt32((uint32_t) i);
+}
+
+void PayloadWriter::writeUInt32(uint32_t i) {
+	for(int shift = 0; shift < 32; shift += 8) {
+		out.push_back((char) ((i >> shift) & 0xFF));
+	}
+}
+
+void PayloadWriter::writeUInt64(uint64_t i) {
+	for(int shift = 0; shift < 64; shift += 8) {
+		out.push_back((char) ((i >> shift) & 0xFF));
+	}
+}
+
+void PayloadWriter::writeString(const std::string & s) {
+	writeUInt32(s.size());
+	out.append(s);
+}
@@ -13,3 +13,11 @@ PromptEventData::~PromptEventData()
 std::string PromptEventData::getType() {
 	return t;
 }
+
+void PromptEventData::serialize(PayloadWriter & out) const {
+	out.writeString(t);
+}
+
+EventData * PromptEventData::deserialize(PayloadReader & in) {
+	return new PromptEventData(in.readString());
+}
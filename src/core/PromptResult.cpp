@@ -3,6 +3,7 @@
 PromptResult::PromptResult()
 {
 	isTimedOut = true;
+	d = nullptr;
 }
 
 PromptResult::PromptResult(void * data) {
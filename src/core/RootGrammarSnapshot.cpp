@@ -0,0 +1,38 @@
+#include "RootGrammarSnapshot.h"
+#include "StringHelper.h"
+#include "Mode.h"
+
+#include <cstring>
+#include <sstream>
+
+RootGrammarSnapshot::RootGrammarSnapshot(unsigned long g, unsigned long v, const GrammarMatcher & m, const std::string & t) : generation(g), variableChanges(v), text(t), matcher(m), complete(m.isComplete())
+{
+	if(!complete) { // A Mode has a rule the matcher can not compile, so keep a copy of the whole root grammar
+		std::istringstream copy("#JSGF V1.0;\n" + text);
+		fallback.reset(new Grammar(copy));
+	}
+}
+
+GrammarMatch RootGrammarSnapshot::match(const std::string & command) const {
+	if(complete) {
+		return matcher.match(command);
+	}
+
+	fallbackLock.lock();
+	MatchResult m = fallback->match(command);
+	fallbackLock.unlock();
+
+	GrammarMatch result;
+	result.tags = m.getMatchingTags();
+	if(m.matches) {
+		for(std::vector<std::string>::iterator i = result.tags.begin(); i != result.tags.end(); i++) { // Iterate until we find the tag that tells use which mode this input matches (MODE_TAG_PREFIX)
+			if(StringHelper::stringStartsWith(*i, MODE_TAG_PREFIX)) { // Found the tag telling us which mode it matches, the remaining tags go to the mode
+				result.matches = true;
+				result.mode = i->substr(strlen(MODE_TAG_PREFIX));
+				result.tags.erase(i);
+				break;
+			}
+		}
+	}
+	return result;
+}
@@ -1,4 +1,5 @@
 #include "ServiceControlEventData.h"
+#include "ObjectPool.h"
 
 ServiceControlEventData::ServiceControlEventData(Service * s)
 {
@@ -9,3 +10,15 @@ ServiceControlEventData::~ServiceControlEventData()
 {
 	//dtor
 }
+
+void * ServiceControlEventData::operator new(std::size_t size) {
+	return ObjectPool<ServiceControlEventData>::allocate(size);
+}
+
+void ServiceControlEventData::operator delete(void * p, std::size_t size) {
+	ObjectPool<ServiceControlEventData>::release(p, size);
+}
+
+void ServiceControlEventData::serialize(PayloadWriter & out) const {
+	out.writeString(service == nullptr ? "" : service->getName());
+}
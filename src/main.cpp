@@ -19,6 +19,7 @@
 #include "Buckey.h"
 #include "Service.h"
 #include "MimicTTSService.h"
+#include "EventJournal.h"
 
 #include "cppfs/FileHandle.h"
 #include "cppfs/fs.h"
@@ -43,6 +44,9 @@ pid_t PID;
 cppfs::FileHandle configDir, coreConfigDir, tempDir, assetsDir, coreAssetsDir, coreConfigFile;
 
 void makeBuckey();
+void replay(const std::string & path, bool realtime);
+int connectToBuckey();
+int sendBatch(const std::string & path, unsigned int concurrency);
 void doShutdown();
 void signalHandler(int);
 void daemonize();
@@ -88,7 +92,7 @@ void signalHandler(int signal) {
 		case SIGTSTP:
 		case SIGTERM:
 			syslog(LOG_INFO,"Terminate Signal Received...");
-			buckey->requestStop();
+			buckey->requestStopFromSignal();
 			//exit(0);
 			break;
 		default:
@@ -175,7 +179,7 @@ void daemonize()
 
 		if(buckey->isRunning()) {
 			if(s != "") {
-				buckey->passCommand(s);
+				buckey->passCommand(s, INPUT_SOURCE_CONSOLE);
 			}
 		}
 		else {
@@ -188,6 +192,108 @@ void daemonize()
 	exit(0);
 }
 
+///Runs a headless Buckey, feeds it the event journal and prints what the listeners did with it
+void replay(const std::string & path, bool realtime) {
+	EventJournal::getInstance()->setReplayMode(true); // Do not let Buckey record over the journal we are reading
+	buckey = Buckey::getReplayInstance(configDir, assetsDir, tempDir); // No services, socket or sound, so only the journal drives it
+
+	unsigned long replayed, skipped;
+	std::cout << "Replaying event journal " << path << (realtime ? " at the recorded speed" : " as fast as possible") << std::endl;
+	if(!EventJournal::getInstance()->replay(path, realtime, replayed, skipped)) {
+		std::cerr << "Could not read event journal " << path << std::endl;
+	}
+	else {
+		std::cout << "Replayed " << replayed << " events, skipped " << skipped << std::endl;
+	}
+
+	//Let the listeners of the replayed events finish before reporting on them
+	while(buckey->handlerCount() > 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	std::cout << buckey->getEventStatistics();
+
+	buckey->requestStop();
+	delete buckey;
+}
+
+///Connects to the UNIX socket of the running Buckey, exits if it can not
+int connectToBuckey() {
+	//Open the unix socket
+	int socketHandle;
+	struct sockaddr_un remote;
+
+	socketHandle = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(socketHandle == -1) {
+		syslog(LOG_ERR, "Error opening client unix socket!");
+		std::cout << "Error opening client unix socket!" << std::endl;
+		exit(-1);
+	}
+
+	remote.sun_family = AF_UNIX;
+	std::string socketPath = coreConfig["unix-socket-path"].as<std::string>();
+	strcpy(remote.sun_path, socketPath.c_str());
+
+	int len = strlen(remote.sun_path) + sizeof(remote.sun_family);
+
+	int res = connect(socketHandle, (struct sockaddr *)&remote, len);
+	if(res == -1) {
+		syslog(LOG_ERR, "Error connecting to server unix socket!");
+		std::cout << "Error connecting to server unix socket! " << coreConfig["unix-socket-path"].as<std::string>() << std::endl;
+		exit(-1);
+	}
+	return socketHandle;
+}
+
+///Sends every line of the file, or of stdin if path is "-", to the running Buckey as one command batch and prints its report
+int sendBatch(const std::string & path, unsigned int concurrency) {
+	std::ifstream file;
+	if(path != "-") {
+		file.open(path);
+		if(!file.is_open()) {
+			std::cerr << "Could not open command batch " << path << std::endl;
+			return 1;
+		}
+	}
+	std::istream & in = path == "-" ? std::cin : file;
+
+	int socketHandle = connectToBuckey();
+	std::string s = std::string(BATCH_QUERY) + " " + std::to_string(concurrency) + "\n";
+	bool sent = send(socketHandle, s.c_str(), s.length(), MSG_NOSIGNAL) != -1;
+	unsigned long commands = 0, skipped = 0;
+	while(sent && getline(in, s)) {
+		if(s.length() == 0) {
+			continue;
+		}
+		if(s.length() > MAX_COMMAND_SIZE-1) {
+			skipped++;
+			continue;
+		}
+		s += '\n';
+		sent = send(socketHandle, s.c_str(), s.length(), MSG_NOSIGNAL) != -1; // Blocks while Buckey has as many of the batch in its pipeline as it may
+		commands++;
+	}
+	s = std::string(BATCH_END_QUERY) + "\n";
+	if(!sent || send(socketHandle, s.c_str(), s.length(), MSG_NOSIGNAL) == -1) {
+		std::cout << "Error while sending to unix socket connection!" << std::endl;
+		close(socketHandle);
+		return 1;
+	}
+	shutdown(socketHandle, SHUT_WR); // Buckey closes the connection once it sent the report
+
+	std::cout << "Sent " << commands << " commands";
+	if(skipped > 0) {
+		std::cout << ", skipped " << skipped << " longer than " << MAX_COMMAND_SIZE-1 << " characters";
+	}
+	std::cout << std::endl;
+	char buffer[SOCKET_BUFFER_SIZE];
+	ssize_t received;
+	while((received = recv(socketHandle, buffer, SOCKET_BUFFER_SIZE, 0)) > 0) {
+		std::cout.write(buffer, received);
+	}
+	close(socketHandle);
+	return 0;
+}
+
 void makeBuckey() {
 	///The configuration, assets, and temp directories are all passed onto Buckey to use.
 	///Buckey then handles loading configuration and enabling services
@@ -224,6 +330,33 @@ bool setupDirectories() {
 	if(!coreConfigFile.exists()) {
 		YAML::Emitter e;
 		coreConfig["unix-socket-path"] = "buckey.socket";
+		coreConfig["event-workers"] = EventDispatcher::getWorkerCount();
+		coreConfig["event-deadlines"]["realtime"] = EventDispatcher::getDeadline(EventPriority::REALTIME);
+		coreConfig["event-deadlines"]["interactive"] = EventDispatcher::getDeadline(EventPriority::INTERACTIVE);
+		coreConfig["event-deadlines"]["background"] = EventDispatcher::getDeadline(EventPriority::BACKGROUND);
+		coreConfig["event-limits"][ONOUTPUT]["in-flight"] = DEFAULT_OUTPUT_IN_FLIGHT;
+		coreConfig["event-limits"][ONOUTPUT]["queue"] = DEFAULT_OUTPUT_QUEUE;
+		coreConfig["event-limits"][ONOUTPUT]["overflow"] = FlowControl::getPolicyName(OverflowPolicy::BLOCK);
+		coreConfig["event-journal"] = "";
+		coreConfig["mode-executors"]["echo"]["concurrency"] = DEFAULT_MODE_CONCURRENCY;
+		coreConfig["mode-executors"]["echo"]["queue"] = DEFAULT_MODE_QUEUE;
+		coreConfig["mode-executors"]["echo"]["timeout"] = 0;
+		coreConfig["match-cache"]["size"] = DEFAULT_MATCH_CACHE_SIZE;
+		coreConfig["dedup"]["window"] = DEFAULT_DEDUP_WINDOW;
+		coreConfig["dedup"]["modes"] = YAML::Node(YAML::NodeType::Map);
+		coreConfig["dedup"]["exempt-sources"].push_back(INPUT_SOURCE_BATCH);
+		coreConfig["input-pipeline"]["filters"] = YAML::Node(YAML::NodeType::Sequence);
+		for(int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+			PipelineStageType stage = (PipelineStageType) i;
+			coreConfig["input-pipeline"][InputPipeline::getStageName(stage)]["workers"] = DEFAULT_PIPELINE_WORKERS;
+			coreConfig["input-pipeline"][InputPipeline::getStageName(stage)]["queue"] = DEFAULT_PIPELINE_QUEUE;
+		}
+		coreConfig["event-bus"]["name"] = EVENT_BUS_NAME;
+		coreConfig["event-bus"]["events"].push_back(ON_START_SPEECH);
+		coreConfig["event-bus"]["events"].push_back(ON_HYPOTHESIS);
+		coreConfig["event-bus"]["events"].push_back(ONOUTPUT);
+		coreConfig["event-bus"]["events"].push_back(ON_SPEECH_START);
+		coreConfig["event-bus"]["events"].push_back(ON_SPEECH_END);
 		e << coreConfig;
 		coreConfigFile.writeFile(e.c_str());
 	}
@@ -286,11 +419,17 @@ int main(int argc, char *argv[])
 	bool showStatus = false;
 	bool executeCommand = false;
 	bool executeInput = false;
+	bool replayJournal = false;
+	bool replayRealtime = true;
+	bool executeBatch = false;
+	unsigned int batchConcurrency = DEFAULT_BATCH_CONCURRENCY;
 	char * command;
+	char * journalPath;
+	char * batchPath;
 
     int c;
     opterr = 0;
-	while ((c = getopt (argc, argv, "dhvsc:")) != -1) {
+	while ((c = getopt (argc, argv, "dhvsc:i:r:R:b:n:")) != -1) {
 		switch (c) {
 			case 'd':
 				makeDaemon = true;
@@ -312,6 +451,28 @@ int main(int argc, char *argv[])
 				executeInput = true;
 				command = optarg;
 				break;
+			case 'r':
+				replayJournal = true;
+				journalPath = optarg;
+				break;
+			case 'R':
+				replayJournal = true;
+				replayRealtime = false;
+				journalPath = optarg;
+				break;
+			case 'b':
+				executeBatch = true;
+				batchPath = optarg;
+				break;
+			case 'n': {
+				char * end;
+				batchConcurrency = strtoul(optarg, &end, 10);
+				if(end == optarg || *end != '\0' || batchConcurrency == 0) {
+					fprintf (stderr, "Option -n needs a COUNT of at least 1.\n");
+					return 1;
+				}
+				break;
+			}
 			case '?':
 				if (isprint (optopt)) {
 					fprintf (stderr, "Unknown option `-%c'.\n", optopt);
@@ -331,13 +492,17 @@ int main(int argc, char *argv[])
 		std::cout << "Buckey provides input and output methods in the form of Services that run in the background." << std::endl;
 		std::cout << "Buckey also provides simple command interfaces that can execute programs and scripts through Modes." << std::endl;
 		std::cout << std::endl << "Usage Instructions:" << std::endl;
-        std::cout << "\tbuckey [-c COMMAND | -i INPUT | -s | -h | -v | -d]" << std::endl << std::endl;
+        std::cout << "\tbuckey [-c COMMAND | -i INPUT | -b FILE [-n COUNT] | -r JOURNAL | -R JOURNAL | -s | -h | -v | -d]" << std::endl << std::endl;
         std::cout << "Options:" << std::endl << "\t-c COMMAND\tPasses the specified command to the currently running Buckey daemon." << std::endl;
         std::cout << "\t-h\t\tShow this usage text." << std::endl;
         std::cout << "\t-s\t\tQuery the currently running Buckey daemon about its status." << std::endl;
 	 	std::cout << "\t-c\t\tPass a command to the currently running Buckey instance." << std::endl;
 	 	std::cout << "\t-i\t\tPass input to the currently running Buckey instance." << std::endl;
+        std::cout << "\t-b FILE\t\tPass every line of FILE, or of stdin if FILE is -, to the currently running Buckey instance as a command and print how fast they went through." << std::endl;
+        std::cout << "\t-n COUNT\tWith -b, the most commands Buckey works on at once. Defaults to " << DEFAULT_BATCH_CONCURRENCY << "." << std::endl;
         std::cout << "\t-d\t\tStart a new Buckey daemon if one is not running already."<< std::endl;
+        std::cout << "\t-r JOURNAL\tStart a Buckey without services, sound, socket or console input, replay the event journal into it at the recorded speed, print the event statistics and exit." << std::endl;
+        std::cout << "\t-R JOURNAL\tLike -r, but replay the event journal as fast as possible." << std::endl;
         std::cout << "\t-v\t\tDisplay the current version of this program." << std::endl << std::endl;
         std::cout << "If no options are supplied, a new Buckey instance will be made unless another Buckey instance is already running." << std::endl;
         std::cout << "If another Buckey instance is running, this program will supply a command line interface to communicate with the running Buckey instance." << std::endl;
@@ -419,31 +584,14 @@ int main(int argc, char *argv[])
 
 	}
 
+	//User requested to send a batch of commands. Stream them to the UNIX socket and print the report
+	if(executeBatch) {
+		return sendBatch(batchPath, batchConcurrency);
+	}
+
 	//User requested to only send a command. Connect to the UNIX socket and send it.
 	if(executeCommand || executeInput) {
-		//Open the unix socket
-		int socketHandle;
-		struct sockaddr_un remote;
-
-		socketHandle = socket(AF_UNIX, SOCK_STREAM, 0);
-		if(socketHandle == -1) {
-			syslog(LOG_ERR, "Error opening client unix socket!");
-			std::cout << "Error opening client unix socket!" << std::endl;
-			exit(-1);
-		}
-
-		remote.sun_family = AF_UNIX;
-		std::string socketPath = coreConfig["unix-socket-path"].as<std::string>();
-		strcpy(remote.sun_path, socketPath.c_str());
-
-		int len = strlen(remote.sun_path) + sizeof(remote.sun_family);
-
-		int res = connect(socketHandle, (struct sockaddr *)&remote, len);
-		if(res == -1) {
-			syslog(LOG_ERR, "Error connecting to server unix socket!");
-			std::cout << "Error connecting to server unix socket! " << coreConfig["unix-socket-path"].as<std::string>() << std::endl;
-			exit(-1);
-		}
+		int socketHandle = connectToBuckey();
 
 		std::string s(command);
 		if(executeCommand) {
@@ -481,29 +629,7 @@ int main(int argc, char *argv[])
 		syslog(LOG_INFO, "Another buckey process is running! Turning into command line mode.");
 		cout << "It appears that another Buckey process is running, this process will become a command line to communicate with the other process!" << std::endl;
 
-		//Open the unix socket
-		int socketHandle;
-		struct sockaddr_un remote;
-
-		socketHandle = socket(AF_UNIX, SOCK_STREAM, 0);
-		if(socketHandle == -1) {
-			syslog(LOG_ERR, "Error opening client unix socket!");
-			std::cout << "Error opening client unix socket!" << std::endl;
-			exit(-1);
-		}
-
-		remote.sun_family = AF_UNIX;
-		std::string socketPath = coreConfig["unix-socket-path"].as<std::string>();
-		strcpy(remote.sun_path, socketPath.c_str());
-
-		int len = strlen(remote.sun_path) + sizeof(remote.sun_family);
-
-		int res = connect(socketHandle, (struct sockaddr *)&remote, len);
-		if(res == -1) {
-			syslog(LOG_ERR, "Error connecting to server unix socket!");
-			std::cout << "Error connecting to server unix socket! " << coreConfig["unix-socket-path"].as<std::string>() << std::endl;
-			exit(-1);
-		}
+		int socketHandle = connectToBuckey();
 
 		std::string s;
 		while(true) {
@@ -541,6 +667,9 @@ int main(int argc, char *argv[])
 		if(makeDaemon) {
 			daemonize();
 		}
+		else if(replayJournal) {
+			replay(journalPath, replayRealtime);
+		}
 		else {
 			makeBuckey();
 
@@ -560,7 +689,7 @@ int main(int argc, char *argv[])
 
 				if(!buckey->isKilled()) {
 					if(s != "") {
-						buckey->passInput(s);
+						buckey->passInput(s, INPUT_SOURCE_CONSOLE);
 					}
 				}
 				else {
@@ -1,4 +1,5 @@
 #include "HypothesisEventData.h"
+#include "ObjectPool.h"
 
 HypothesisEventData::HypothesisEventData(std::string h)
 {
@@ -14,3 +15,19 @@ HypothesisEventData::~HypothesisEventData()
 std::string HypothesisEventData::getHypothesis() const {
     return hypothesis;
 }
+
+void * HypothesisEventData::operator new(std::size_t size) {
+	return ObjectPool<HypothesisEventData>::allocate(size);
+}
+
+void HypothesisEventData::operator delete(void * p, std::size_t size) {
+	ObjectPool<HypothesisEventData>::release(p, size);
+}
+
+void HypothesisEventData::serialize(PayloadWriter & out) const {
+	out.writeString(hypothesis);
+}
+
+EventData * HypothesisEventData::deserialize(PayloadReader & in) {
+	return new HypothesisEventData(in.readString());
+}
@@ -11,7 +11,6 @@ unsigned long SphinxMode::serviceDisableHandler = 0;
 unsigned long SphinxMode::serviceRegisterHandler = 0;
 std::atomic<bool> SphinxMode::sphinxRunning(false);
 std::atomic<bool> SphinxMode::instanceSet(false);
-std::chrono::high_resolution_clock::time_point SphinxMode::lastToggleTimePoint = std::chrono::high_resolution_clock::now();
 SphinxMode * SphinxMode::instance = nullptr;
 
 SphinxMode * SphinxMode::getInstance() {
@@ -26,7 +25,7 @@ SphinxMode::SphinxMode()
 {
 	name = "pyramid";
 	setState(ModeState::STOPPED);
-	lastToggleTimePoint = std::chrono::high_resolution_clock::now();
+	repeatWindow = SPHINX_REPEAT_WINDOW; // Buckey drops toggles and other commands heard twice
 }
 
 void SphinxMode::setupAssetsDir(cppfs::FileHandle aDir) {
@@ -55,9 +54,10 @@ void SphinxMode::start() {
 	grammar = new DynamicGrammar(i);
 	delete i;
 	Buckey * b = Buckey::getInstance();
-	SphinxMode::serviceEnableHandler = b->addListener(ONSERVICEENABLE, SphinxMode::serviceEnabledEventHandler);
-	SphinxMode::serviceDisableHandler = b->addListener(ONSERVICEDISABLE, SphinxMode::serviceDisabledEventHandler);
-	SphinxMode::serviceRegisterHandler = b->addListener(ONSERVICEREGISTER, SphinxMode::serviceEventHandler);
+	// These handlers only compare a name and flip an atomic, so they are ran on the triggering thread
+	SphinxMode::serviceEnableHandler = b->addListener(ONSERVICEENABLE_ID, SphinxMode::serviceEnabledEventHandler, DispatchPolicy::INLINE);
+	SphinxMode::serviceDisableHandler = b->addListener(ONSERVICEDISABLE_ID, SphinxMode::serviceDisabledEventHandler, DispatchPolicy::INLINE);
+	SphinxMode::serviceRegisterHandler = b->addListener(ONSERVICEREGISTER_ID, SphinxMode::serviceEventHandler, DispatchPolicy::INLINE);
 
 
 	b->addModeToRootGrammar(this, grammar);
@@ -66,9 +66,9 @@ void SphinxMode::start() {
 
 void SphinxMode::stop() {
 	Buckey * b = Buckey::getInstance();
-    b->unsetListener(ONSERVICEENABLE, SphinxMode::serviceEnableHandler);
-	b->unsetListener(ONSERVICEDISABLE, SphinxMode::serviceDisableHandler);
-	b->unsetListener(ONSERVICEREGISTER, SphinxMode::serviceRegisterHandler);
+    b->unsetListener(ONSERVICEENABLE_ID, SphinxMode::serviceEnableHandler);
+	b->unsetListener(ONSERVICEDISABLE_ID, SphinxMode::serviceDisableHandler);
+	b->unsetListener(ONSERVICEREGISTER_ID, SphinxMode::serviceRegisterHandler);
 
 	b->removeModeFromRootGrammar(this, grammar);
 	delete grammar;
@@ -114,19 +114,6 @@ void SphinxMode::input(std::string & command, std::vector<std::string> & tags) {
 			}
 		}
 		else if (action == "toggle") {
-			//See how many milliseconds it has been since the last toggle command has been processed.
-			std::chrono::high_resolution_clock::time_point stop = std::chrono::high_resolution_clock::now();
-			int millisDiff = std::chrono::duration_cast<std::chrono::milliseconds>(stop - lastToggleTimePoint).count();
-
-			//Received the toggle command but we already received a toggle command less than TOGGLE_DEBOUNCE_TIME milliseconds ago so ignore this command b/c it is probably a repeat
-			if(millisDiff < TOGGLE_DEBOUNCE_TIME) {
-                return;
-			}
-			else {
-				//Process this toggle command and log the timestamp so we know to ignore repeat commands that come in a few milliseconds
-				lastToggleTimePoint = stop;
-			}
-
 			if(s->inPressToSpeak()) {
 				if(s->pressToSpeakIsPressed()) {
 					//std::this_thread::sleep_for(std::chrono::seconds(1));
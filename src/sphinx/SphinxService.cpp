@@ -23,14 +23,18 @@ std::string SphinxService::getName() const {
 	return "sphinx";
 }
 
+cppfs::FileHandle SphinxService::getConfirmGrammarFile() {
+	cppfs::FileHandle confirmGram = assetsDir.open("confirm.gram");
+	if(!confirmGram.isFile()) {
+		setupAssets(assetsDir);
+	}
+	return confirmGram;
+}
+
 void SphinxService::setupAssets(cppfs::FileHandle aDir) {
 	cppfs::FileHandle confirmGram = aDir.open("confirm.gram");
 
-	if(!confirmGram.writeFile("#JSGF v1.0;\n\
-grammar confirm;\n\
-public <command> = <positive> {yes} | <deny> {no};\n\
-<positive> = yes | yeah | ok | positive | confirm | of course | please do | yes sir;\n\
-<deny> = no | deny | reject | [please] don't | nope | do not;")) {
+	if(!confirmGram.writeFile(CONFIRM_GRAMMAR)) {
 		///TODO: Error setting up confirm.gram
 		Buckey::logError("SphinxService failed to create confirm.gram asset file.");
 	}
@@ -53,7 +57,8 @@ void SphinxService::setupConfig(cppfs::FileHandle cDir) {
 }
 
 SphinxService::SphinxService() : manageThreadRunning(false), currentDecoderIndex(0), inUtterance(false), endLoop(false), paused(false), pressToSpeakMode(false), pressToSpeakPressed(false) {
-
+	setJournalName(getName());
+	EventJournal::getInstance()->setDecoder(ON_HYPOTHESIS_ID, HypothesisEventData::deserialize);
 }
 
 SphinxService::~SphinxService()
@@ -100,16 +105,16 @@ void SphinxService::start() {
 	startPressToSpeakRecognition(deviceName);
     ///TODO: Set listeners
 
-    onEnterPromptEventHandlerID = Buckey::getInstance()->addListener("onEnterPromptEvent", onEnterPromptEventHandler);
-    onConversationEndEventHandlerID = Buckey::getInstance()->addListener("onExitPromptEvent", onConversationEndEventHandler);
+    onEnterPromptEventHandlerID = Buckey::getInstance()->addListener(ONENTERPROMPT_ID, onEnterPromptEventHandler);
+    onConversationEndEventHandlerID = Buckey::getInstance()->addListener(ONEXITPROMPT_ID, onConversationEndEventHandler);
 
     setState(ServiceState::RUNNING);
 }
 
 void SphinxService::stop() {
 	if(getState() == ServiceState::RUNNING) {
-		Buckey::getInstance()->unsetListener("onEnterPromptEvent", onEnterPromptEventHandlerID);
-		Buckey::getInstance()->unsetListener("onExitPromptEvent", onConversationEndEventHandlerID);
+		Buckey::getInstance()->unsetListener(ONENTERPROMPT_ID, onEnterPromptEventHandlerID);
+		Buckey::getInstance()->unsetListener(ONEXITPROMPT_ID, onConversationEndEventHandlerID);
 		stopRecognition();
 	}
 	setState(ServiceState::STOPPED);
@@ -125,11 +130,11 @@ void SphinxService::stopRecognition() {
 
 void SphinxService::pauseRecognition() {
 	paused.store(true);
-	triggerEvents(ON_PAUSE, new EventData());
+	triggerEvents(ON_PAUSE_ID, new EventData());
 }
 
 void SphinxService::resumeRecognition() {
-	triggerEvents(ON_RESUME, new EventData());
+	triggerEvents(ON_RESUME_ID, new EventData());
 	paused.store(false);
 }
 
@@ -157,7 +162,7 @@ void SphinxService::onEnterPromptEventHandler(EventData * data, std::atomic<bool
 	PromptEventData * d = (PromptEventData *) data;
 	Buckey::logInfo("enter prompt event handler");
 	if(d->getType() == "confirm") {
-        SphinxService::getInstance()->updateJSGFPath(SphinxService::getInstance()->assetsDir.open("confirm.gram").path());
+        SphinxService::getInstance()->updateJSGFPath(SphinxService::getInstance()->getConfirmGrammarFile().path());
         SphinxService::getInstance()->applyUpdates();
         Buckey::logInfo("switched grammars");
 	}
@@ -166,7 +171,7 @@ void SphinxService::onEnterPromptEventHandler(EventData * data, std::atomic<bool
 
 void SphinxService::onConversationEndEventHandler(EventData * data, std::atomic<bool> * done) {
 	Buckey::logInfo("exit prompt event handler");
-	SphinxService::getInstance()->setJSGF(Buckey::getInstance()->getRootGrammar());
+	SphinxService::getInstance()->setJSGF(Buckey::getInstance()->getRootGrammarText());
 	SphinxService::getInstance()->applyUpdates();
 	done->store(true);
 }
@@ -239,11 +244,11 @@ void SphinxService::manageNonContinuousDecoders(SphinxService * sr) {
 
     sr->recognizing.store(false);
 
-    sr->triggerEvents(ON_READY, new EventData());
+    sr->triggerEvents(ON_READY_ID, new EventData());
     Buckey::getInstance()->reply("Sphinx Speech Recognition Ready", ReplyType::CONSOLE);
 	sr->updateLock.unlock();
 
-	sr->triggerEvents(ON_SERVICE_READY, new EventData());
+	sr->triggerEvents(ON_SERVICE_READY_ID, new EventData());
 
     while(!b->isKilled() && !sr->endLoop.load()) {
 
@@ -316,7 +321,7 @@ void SphinxService::manageNonContinuousDecoders(SphinxService * sr) {
 			// Silence to speech transition
 			// Trigger onSpeechStart
 			if(sr->voiceDetected && !sr->inUtterance) {
-				sr->triggerEvents(ON_START_SPEECH, new EventData());
+				sr->triggerEvents(ON_START_SPEECH_ID, new EventData());
 				sr->inUtterance.store(true);
 				b->playSoundEffect(SoundEffects::READY, false);
 			}
@@ -430,11 +435,11 @@ void SphinxService::manageContinuousDecoders(SphinxService * sr) {
     }
 
     sr->recognizing.store(true);
-    sr->triggerEvents(ON_READY, new EventData());
+    sr->triggerEvents(ON_READY_ID, new EventData());
     Buckey::getInstance()->reply("Sphinx Speech Recognition Ready", ReplyType::CONSOLE);
 	sr->updateLock.unlock();
 
-	sr->triggerEvents(ON_SERVICE_READY, new EventData());
+	sr->triggerEvents(ON_SERVICE_READY_ID, new EventData());
 
     while(!sr->endLoop.load()) {
 
@@ -498,7 +503,7 @@ void SphinxService::manageContinuousDecoders(SphinxService * sr) {
                 Buckey::logInfo("Reached end of audio file, stopping speech recognition...");
                 if(sr->inUtterance) { // Reached end of file before end of speech, so stop recognition and get the hypothesis
 					sr->decoderIndexLock.lock();
-                    sr->triggerEvents(ON_END_SPEECH, new EventData()); // TODO: Add event data
+                    sr->triggerEvents(ON_END_SPEECH_ID, new EventData()); // TODO: Add event data
                     sr->inUtterance.store(false);
                     sr->decoders[sr->currentDecoderIndex]->ready = false;
                     sr->miscThreads.push_back(std::thread(endAndGetHypothesis, sr, sr->decoders[sr->currentDecoderIndex]));
@@ -518,7 +523,7 @@ void SphinxService::manageContinuousDecoders(SphinxService * sr) {
         // Silence to speech transition
         // Trigger onSpeechStart
         if(sr->voiceDetected && !sr->inUtterance) {
-            sr->triggerEvents(ON_START_SPEECH, new EventData());
+            sr->triggerEvents(ON_START_SPEECH_ID, new EventData());
             sr->inUtterance.store(true);
 			b->playSoundEffect(SoundEffects::READY, false);
         }
@@ -529,7 +534,7 @@ void SphinxService::manageContinuousDecoders(SphinxService * sr) {
         if(!sr->voiceDetected && sr->inUtterance) {
 
 	    sr->decoderIndexLock.lock();
-            sr->triggerEvents(ON_END_SPEECH, new EventData()); //TODO: Add event data
+            sr->triggerEvents(ON_END_SPEECH_ID, new EventData()); //TODO: Add event data
             sr->inUtterance.store(false);
             sr->decoders[sr->currentDecoderIndex]->ready = false;
             sr->miscThreads.push_back(std::thread(endAndGetHypothesis, sr, sr->decoders[sr->currentDecoderIndex]));
@@ -623,8 +628,8 @@ void SphinxService::endAndGetHypothesis(SphinxService * sr, SphinxDecoder * sd)
     if(hyp != "") { // Ignore false alarms
 		Buckey::logInfo("Got hypothesis: " + hyp);
 		Buckey::getInstance()->playSoundEffect(SoundEffects::OK, false);
-        sr->triggerEvents(ON_HYPOTHESIS, new HypothesisEventData(hyp));
-        Buckey::getInstance()->passInput(hyp);
+        sr->triggerEvents(ON_HYPOTHESIS_ID, new HypothesisEventData(hyp));
+        Buckey::getInstance()->passInput(hyp, INPUT_SOURCE_SPEECH);
     }
     sd->startUtterance();
 }
@@ -712,9 +717,13 @@ void SphinxService::updateSearchMode(SphinxHelper::SearchMode mode) {
 }
 
 void SphinxService::setJSGF(Grammar * g) {
-	///TODO: Save Grammar to a temp file, pass the path of the temp file on to the sphinx decoders
+	setJSGF(g->getText());
+}
+
+///Saves the grammar text, without the #JSGF header, to a temp file and passes its path on to the sphinx decoders
+void SphinxService::setJSGF(const std::string & grammarText) {
     cppfs::FileHandle t = Buckey::getInstance()->getTempFile(".gram");
-    t.writeFile("#JSGF V1.0;\n" + g->getText());
+    t.writeFile("#JSGF V1.0;\n" + grammarText);
     updateJSGFPath(t.path());
 }
 
@@ -791,33 +800,33 @@ SphinxDecoder * SphinxService::getDecoder(unsigned short decoderIndex) {
 }
 
 void SphinxService::addOnSpeechStart(void(*handler)(EventData *, std::atomic<bool> *)) {
-    addListener(ON_START_SPEECH, handler);
+    addListener(ON_START_SPEECH_ID, handler);
 }
 
 void SphinxService::addOnSpeechEnd(void(*handler)(EventData *, std::atomic<bool> *)) {
-    addListener(ON_END_SPEECH, handler);
+    addListener(ON_END_SPEECH_ID, handler);
 }
 
 void SphinxService::addOnHypothesis(void(*handler)(EventData *, std::atomic<bool> *)) {
-    addListener(ON_HYPOTHESIS, handler);
+    addListener(ON_HYPOTHESIS_ID, handler);
 }
 
 void SphinxService::clearSpeechStartListeners() {
-	clearListeners(ON_START_SPEECH);
+	clearListeners(ON_START_SPEECH_ID);
 }
 
 void SphinxService::clearSpeechEndListeners() {
-	clearListeners(ON_END_SPEECH);
+	clearListeners(ON_END_SPEECH_ID);
 }
 
 void SphinxService::clearOnHypothesisListeners() {
-	clearListeners(ON_HYPOTHESIS);
+	clearListeners(ON_HYPOTHESIS_ID);
 }
 
 void SphinxService::clearOnPauseListeners() {
-	clearListeners(ON_PAUSE);
+	clearListeners(ON_PAUSE_ID);
 }
 
 void SphinxService::clearOnResumeListeners() {
-	clearListeners(ON_RESUME);
+	clearListeners(ON_RESUME_ID);
 }
@@ -10,3 +10,7 @@ AsyncSpeechRequestEventData::~AsyncSpeechRequestEventData()
 {
 	//dtor
 }
+
+void AsyncSpeechRequestEventData::serialize(PayloadWriter & out) const {
+	out.writeString(text);
+}
@@ -12,7 +12,11 @@ MimicTTSService * MimicTTSService::instance;
 MimicTTSService::MimicTTSService() : TTSService()
 {
 	error = 0;
-	addListener(ASYNC_SPEECH_REQUEST, doAsyncRequest);
+	// Serial so queued requests are spoken in the order they were made
+	addListener(ASYNC_SPEECH_REQUEST_ID, doAsyncRequest, DispatchPolicy::SERIAL);
+	setJournalName(getName());
+	EventJournal::getInstance()->setDecoder(ASYNC_SPEECH_REQUEST_ID, decodeAsyncRequest);
+	EventJournal::getInstance()->setDecoder(ON_MIMIC_AUDIO_PREPARED_ID, SpeechPreparedEventData::deserialize);
 }
 
 MimicTTSService * MimicTTSService::getInstance() {
@@ -96,7 +100,7 @@ void MimicTTSService::prepareSpeech(std::string words) {
 
     preparedAudio.push_back(std::pair<std::string, std::string>(words, fileName));
 	delete w;
-	triggerEvents(ON_MIMIC_AUDIO_PREPARED, new SpeechPreparedEventData(words, fileName));
+	triggerEvents(ON_MIMIC_AUDIO_PREPARED_ID, new SpeechPreparedEventData(words, fileName));
 }
 
 /**
@@ -140,16 +144,14 @@ bool MimicTTSService::speakPreparedSpeech(std::string words) {
 					printf("Mix_LoadWAV: %s\n", Mix_GetError());// handle error
 			}
 
-			while(currentlySpeaking) {
-				//Wait until an opening occurs. This is mainly for async speech calls.
-			}
-
+			std::lock_guard<std::mutex> speaking(speechLock); // Wait until an opening occurs. This is mainly for async speech calls.
 			currentlySpeaking.store(true);
-			triggerEvents(ON_SPEECH_START, new EventData());
+			triggerEvents(ON_SPEECH_START_ID, new EventData());
 
 			int channel = Mix_PlayChannel(-1, sample, false);
 			if(channel == -1) {
 				///ERROR
+				currentlySpeaking.store(false);
 				return false;
 			}
 			Mix_Volume(channel, 128);
@@ -159,7 +161,7 @@ bool MimicTTSService::speakPreparedSpeech(std::string words) {
 			Mix_FreeChunk(sample);
 
 			currentlySpeaking.store(false);
-			triggerEvents(ON_SPEECH_END, new EventData());
+			triggerEvents(ON_SPEECH_END_ID, new EventData());
 			return true;
 		}
 	}
@@ -180,11 +182,9 @@ int MimicTTSService::speak(std::string words) {
 		}
 
 		//If not prepared yet, synthesize them and speak them
-		while(currentlySpeaking) {
-			//Wait until an opening occurs. This is mainly for async speech calls.
-		}
+		std::lock_guard<std::mutex> speaking(speechLock); // Wait until an opening occurs. This is mainly for async speech calls.
 		currentlySpeaking.store(true);
-		triggerEvents(ON_SPEECH_START, new EventData());
+		triggerEvents(ON_SPEECH_START_ID, new EventData());
 
 		//error = mimic_text_to_speech(words.c_str(), voice, "play", &durs);
 
@@ -196,6 +196,7 @@ int MimicTTSService::speak(std::string words) {
 		sample->allocated = 0;
 		int channel = Mix_PlayChannel(-1, sample, false);
 		if(channel == -1) {
+			currentlySpeaking.store(false);
 			return false;
 		}
 		while(Mix_Playing(channel)) {
@@ -205,7 +206,7 @@ int MimicTTSService::speak(std::string words) {
 		delete_wave(w);
 
 		currentlySpeaking.store(false);
-		triggerEvents(ON_SPEECH_END, new EventData());
+		triggerEvents(ON_SPEECH_END_ID, new EventData());
 		return error;
 	}
 	return 0;
@@ -229,15 +230,13 @@ unsigned long MimicTTSService::getHistorySize() {
 /// This has not been implemented and probably never will be
 void MimicTTSService::asyncSpeak(std::string words) {
 	if(!stopRequest && state == ServiceState::RUNNING) {
-		triggerEvents(ASYNC_SPEECH_REQUEST, new AsyncSpeechRequestEventData(words, this));
+		triggerEvents(ASYNC_SPEECH_REQUEST_ID, new AsyncSpeechRequestEventData(words, this));
 	}
 }
 
 bool MimicTTSService::stopSpeaking() {
 	stopRequest.store(true);
-	while(currentlySpeaking) {
-		//Wait for it to end
-	}
+	std::lock_guard<std::mutex> speaking(speechLock); // Wait for it to end
 	return true;
 }
 
@@ -246,7 +245,7 @@ bool MimicTTSService::isSpeaking() {
 }
 
 void MimicTTSService::addOnSpeechPrepared(void (*handler)(EventData *, std::atomic<bool> *)) {
-	addListener(ON_MIMIC_AUDIO_PREPARED, handler);
+	addListener(ON_MIMIC_AUDIO_PREPARED_ID, handler);
 }
 
 void MimicTTSService::start() {
@@ -272,28 +271,26 @@ void MimicTTSService::start() {
 		voice = mimic_voice_load(v.c_str());
 		stopRequest.store(false);
 		setState(ServiceState::RUNNING);
-        onOutputHandle = Buckey::getInstance()->addListener(ONOUTPUT, handleOutputs);
+        onOutputHandle = Buckey::getInstance()->addListener(OutputEvent, handleOutputs, DispatchPolicy::SERIAL);
 	}
 }
 
-void MimicTTSService::handleOutputs(EventData * data, std::atomic<bool> * done) {
-    OutputEventData * d = ((OutputEventData *) data);
-    if(d->getType() == ReplyType::CONVERSATION) {
-		getInstance()->asyncSpeak(d->getMessage());
+void MimicTTSService::handleOutputs(const OutputMessage & output) {
+    if(output.type == ReplyType::CONVERSATION) {
+		getInstance()->asyncSpeak(output.message);
     }
-    else if(d->getType() == ReplyType::STATUS) {
-	    getInstance()->asyncSpeak(d->getMessage());
+    else if(output.type == ReplyType::STATUS) {
+	    getInstance()->asyncSpeak(output.message);
     }
-    else if(d->getType() == ReplyType::PROMPT) {
-	    getInstance()->asyncSpeak(d->getMessage());
+    else if(output.type == ReplyType::PROMPT) {
+	    getInstance()->asyncSpeak(output.message);
     }
-	done->store(true);
 }
 
 void MimicTTSService::stop() {
 	if(state == ServiceState::RUNNING) {
 		stopSpeaking();
-		Buckey::getInstance()->unsetListener(ONOUTPUT, onOutputHandle);
+		Buckey::getInstance()->unsetListener(ONOUTPUT_ID, onOutputHandle);
 		Service::setState(ServiceState::STOPPED);
 		mimic_exit();
 	}
@@ -307,7 +304,7 @@ void MimicTTSService::stop() {
 			Service::setState(ServiceState::STOPPED);
 			mimic_exit();
 		}
-		Buckey::getInstance()->unsetListener(ONOUTPUT, onOutputHandle);
+		Buckey::getInstance()->unsetListener(ONOUTPUT_ID, onOutputHandle);
 	}
 }
 
@@ -319,6 +316,10 @@ std::string MimicTTSService::getName() const {
 	return "mimic";
 }
 
+EventData * MimicTTSService::decodeAsyncRequest(PayloadReader & in) {
+	return new AsyncSpeechRequestEventData(in.readString(), getInstance());
+}
+
 void MimicTTSService::doAsyncRequest(EventData * data, std::atomic<bool> * done) {
 	AsyncSpeechRequestEventData * req = (AsyncSpeechRequestEventData *) data;
 	req->tts->speak(req->text);
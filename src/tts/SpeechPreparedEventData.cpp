@@ -14,3 +14,14 @@ SpeechPreparedEventData::~SpeechPreparedEventData()
 {
 	//dtor
 }
+
+void SpeechPreparedEventData::serialize(PayloadWriter & out) const {
+	out.writeString(words);
+	out.writeString(filePath);
+}
+
+EventData * SpeechPreparedEventData::deserialize(PayloadReader & in) {
+	std::string text = in.readString();
+	std::string fileName = in.readString();
+	return new SpeechPreparedEventData(text, fileName);
+}
@@ -7,11 +7,11 @@ TTSService::TTSService() : Service()
 }
 
 void TTSService::addOnSpeechStart(void (*handler)(EventData *, std::atomic<bool> *)) {
-	addListener(ON_SPEECH_START, handler);
+	addListener(ON_SPEECH_START_ID, handler);
 }
 
 void TTSService::addOnSpeechEnd(void (*handler)(EventData *, std::atomic<bool> *)) {
-	addListener(ON_SPEECH_END, handler);
+	addListener(ON_SPEECH_END_ID, handler);
 }
 
 std::string TTSService::getStatusMessage() {
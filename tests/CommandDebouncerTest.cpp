@@ -0,0 +1,69 @@
+#include "CommandDebouncer.h"
+
+#include <chrono>
+#include <string>
+#include <iostream>
+
+using namespace std;
+
+#define WINDOW_MS 100
+
+///Prints a failure and marks the test failed unless the debouncer decided as expected
+void expect(bool & passed, bool accepted, bool expected, const string & what) {
+	if(accepted != expected) {
+		cout << "FAIL: " << what << (expected ? " was dropped" : " was let through") << endl;
+		passed = false;
+	}
+}
+
+int main() {
+	bool passed = true;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	// Repeats are dropped inside the window and let through after it
+	CommandDebouncer d;
+	d.setModeWindow("lights", WINDOW_MS);
+	expect(passed, d.accept("lights on", "sphinx", "lights", start), true, "the first command");
+	expect(passed, d.accept("lights on", "sphinx", "lights", start + chrono::milliseconds(WINDOW_MS / 2)), false, "a repeat inside the window");
+	expect(passed, d.accept("lights on", "sphinx", "lights", start + chrono::milliseconds(WINDOW_MS)), true, "a repeat after the window");
+	expect(passed, d.accept("lights off", "sphinx", "lights", start + chrono::milliseconds(WINDOW_MS)), true, "another command inside the window");
+
+	// Modes without a window of their own use the default, which passes every repeat
+	expect(passed, d.accept("what time is it", "sphinx", "clock", start), true, "a command of a Mode without a window");
+	expect(passed, d.accept("what time is it", "sphinx", "clock", start), true, "a repeat of a Mode without a window");
+	d.setDefaultWindow(WINDOW_MS);
+	expect(passed, d.accept("what time is it", "sphinx", "clock", start + chrono::milliseconds(1)), true, "a command not remembered while the window was 0");
+	expect(passed, d.accept("what time is it", "sphinx", "clock", start + chrono::milliseconds(2)), false, "a repeat inside the default window");
+
+	// The same command from another source is not a repeat
+	expect(passed, d.accept("lights on", "socket", "lights", start + chrono::milliseconds(WINDOW_MS)), true, "the same command from another source");
+	expect(passed, d.accept("lights on", "socket", "lights", start + chrono::milliseconds(WINDOW_MS + 1)), false, "a repeat from the other source");
+
+	// Exempted sources let every repeat through
+	d.exemptSource("batch");
+	expect(passed, d.accept("lights on", "batch", "lights", start), true, "a command from an exempted source");
+	expect(passed, d.accept("lights on", "batch", "lights", start), true, "a repeat from an exempted source");
+	d.clearExemptSources();
+	expect(passed, d.accept("lights on", "batch", "lights", start), true, "a command from a source no longer exempted");
+	expect(passed, d.accept("lights on", "batch", "lights", start), false, "a repeat from a source no longer exempted");
+	cout << d.report() << endl;
+
+	// Commands older than every window are forgotten once DEDUP_PRUNE_SIZE are remembered, newer ones are kept
+	CommandDebouncer p;
+	p.setDefaultWindow(WINDOW_MS);
+	for(int i = 0; i < DEDUP_PRUNE_SIZE - 1; i++) {
+		p.accept("command " + to_string(i), "sphinx", "any", start);
+	}
+	p.accept("recent", "sphinx", "any", start + chrono::milliseconds(WINDOW_MS + WINDOW_MS / 2));
+	p.accept("newest", "sphinx", "any", start + chrono::milliseconds(2 * WINDOW_MS));
+	cout << p.report() << endl;
+	if(p.report().find(" 2 remembered") == string::npos) {
+		cout << "FAIL: pruning did not forget exactly the commands older than the window" << endl;
+		passed = false;
+	}
+	expect(passed, p.accept("recent", "sphinx", "any", start + chrono::milliseconds(2 * WINDOW_MS)), false, "a repeat of a command kept by pruning");
+	expect(passed, p.accept("command 0", "sphinx", "any", start + chrono::milliseconds(2 * WINDOW_MS)), true, "a command forgotten by pruning");
+
+	cout << (passed ? "PASSED" : "FAILED") << endl;
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#include "EventSource.h"
+#include "EventData.h"
+#include "OutputEventData.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+using namespace std;
+
+#define EVENT_COUNT 1000000
+#define WARMUP_COUNT 100000
+#define MAX_GROWTH_KB 1024
+
+atomic<unsigned long> received(0);
+
+class TestSource : public EventSource {
+	public:
+		void fire(unsigned long i) {
+			triggerEvents("onOutputEvent", new OutputEventData("message " + to_string(i), ReplyType::CONSOLE));
+		}
+};
+
+void onOutput(EventData * d, atomic<bool> * done) {
+	OutputEventData * o = (OutputEventData *) d;
+	if(o->getMessage().size() > 0) {
+		received++;
+	}
+	done->store(true);
+}
+
+///Returns the resident set size of this process in KB
+long residentKB() {
+	ifstream statm("/proc/self/statm");
+	long pages = 0, resident = 0;
+	statm >> pages >> resident;
+	return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+void fireBatch(TestSource & s, unsigned long from, unsigned long to) {
+	for(unsigned long i = from; i < to; i++) {
+		s.fire(i);
+		// Keep the producer from racing too far ahead of the listeners, queued tasks are not what we are measuring
+		while(s.handlerCount() > 1000) {
+			this_thread::yield();
+		}
+	}
+	while(s.handlerCount() > 0) {
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+}
+
+int main() {
+	cout << "EventData Lifetime Test" << endl;
+	TestSource s;
+	s.addListener("onOutputEvent", onOutput);
+	s.addListener("onOutputEvent", onOutput);
+
+	fireBatch(s, 0, WARMUP_COUNT);
+	long before = residentKB();
+	cout << "Resident after " << WARMUP_COUNT << " warm up events: " << before << " KB" << endl;
+
+	fireBatch(s, WARMUP_COUNT, EVENT_COUNT);
+	long after = residentKB();
+	cout << "Resident after " << EVENT_COUNT << " events: " << after << " KB" << endl;
+	cout << "Listener calls: " << received.load() << endl;
+
+	if(received.load() != 2 * EVENT_COUNT) {
+		cout << "FAILED: expected " << 2 * EVENT_COUNT << " listener calls" << endl;
+		return -1;
+	}
+
+	if(after - before > MAX_GROWTH_KB) {
+		cout << "FAILED: resident memory grew by " << (after - before) << " KB" << endl;
+		return -1;
+	}
+
+	cout << "PASSED: resident memory grew by " << (after - before) << " KB" << endl;
+	return 0;
+}
@@ -0,0 +1,89 @@
+#include "EventSource.h"
+#include "EventData.h"
+#include "Event.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <iostream>
+
+using namespace std;
+
+#define POOLED_EVENTS 200000
+#define DEDICATED_EVENTS 10000
+
+atomic<unsigned long> received(0);
+
+///A small typed payload, stored inline in the dispatch record
+struct Tick {
+	unsigned long sequence;
+};
+
+const Event<Tick> TickEvent(ONOUTPUT_ID);
+
+class BenchmarkSource : public EventSource {
+	public:
+		void fire() {
+			triggerEvents(ONOUTPUT_ID, new EventData());
+		}
+
+		void fireTyped(unsigned long i) {
+			Tick t;
+			t.sequence = i;
+			triggerEvents(TickEvent, t);
+		}
+};
+
+///A listener that does about as little as SphinxMode's service handlers
+void trivialHandler(EventData * d, atomic<bool> * done) {
+	received++;
+}
+
+void trivialTypedHandler(const Tick & t) {
+	received++;
+}
+
+///Triggers count events at a single listener with the given policy and prints the average cost of one event, including waiting for its listener to finish
+void benchmark(string name, DispatchPolicy policy, unsigned long count, bool typed = false) {
+	BenchmarkSource s;
+	if(typed) {
+		s.addListener(TickEvent, trivialTypedHandler, policy);
+	}
+	else {
+		s.addListener(ONOUTPUT_ID, trivialHandler, policy);
+	}
+	received.store(0);
+
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	for(unsigned long i = 0; i < count; i++) {
+		if(typed) {
+			s.fireTyped(i);
+		}
+		else {
+			s.fire();
+		}
+	}
+	while(s.handlerCount() > 0) {
+		this_thread::yield();
+	}
+	chrono::high_resolution_clock::time_point stop = chrono::high_resolution_clock::now();
+
+	double nanos = chrono::duration_cast<chrono::nanoseconds>(stop - start).count();
+	cout << name << ": " << count << " events, " << (nanos / count) << " ns per event";
+	if(received.load() != count) {
+		cout << " (only " << received.load() << " listener calls!)";
+	}
+	cout << endl;
+}
+
+int main() {
+	cout << "Event Dispatch Benchmark" << endl;
+	cout << "Workers: " << EventDispatcher::getWorkerCount() << endl;
+	benchmark("INLINE", DispatchPolicy::INLINE, POOLED_EVENTS);
+	benchmark("POOLED", DispatchPolicy::POOLED, POOLED_EVENTS);
+	benchmark("DEDICATED", DispatchPolicy::DEDICATED, DEDICATED_EVENTS);
+	benchmark("SERIAL", DispatchPolicy::SERIAL, POOLED_EVENTS);
+	benchmark("TYPED INLINE", DispatchPolicy::INLINE, POOLED_EVENTS, true);
+	benchmark("TYPED POOLED", DispatchPolicy::POOLED, POOLED_EVENTS, true);
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include "DynamicGrammar.h"
+#include "GrammarMatcher.h"
+#include "alternativeset.h"
+#include "sequence.h"
+#include "Mode.h"
+
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <iostream>
+#include <cstring>
+
+using namespace std;
+
+#define MODE_COUNT 60
+#define MATCHES_PER_COMMAND 200
+
+///Names the Modes like a user would, so no two share their first word
+string modeWord(int i) {
+	return "device" + to_string(i);
+}
+
+///A Mode grammar shaped like CoreMode's, with alternatives, optional words, repeats and tags
+string modeGrammar(int i) {
+	string w = modeWord(i);
+	return "grammar " + w + ";\n"
+		"public <command> = " + w + " (<switch> | <level> | <status>);\n"
+		"<switch> = (turn | switch) ((on {on}) | (off {off})) [please];\n"
+		"<level> = set level (one {1} | two {2} | three {3} | four {4} | five {5}) [percent];\n"
+		"<status> = (what is | tell me) [the] (status {status} | temperature {temperature} | battery {battery} | <$extra> {extra}) <more>*;\n"
+		"<more> = and more;";
+}
+
+int main() {
+	// The root grammar built the way Buckey::init() and Buckey::addModeToRootGrammar() build it
+	DynamicGrammar root;
+	shared_ptr<AlternativeSet> modeList(new AlternativeSet());
+	shared_ptr<Sequence> rootExpansion(new Sequence());
+	rootExpansion->addChild(shared_ptr<Token>(new Token("buckey")));
+	rootExpansion->addChild(modeList);
+	root.addRule(shared_ptr<Rule>(new Rule("root", true, rootExpansion)));
+
+	GrammarMatcher matcher;
+	matcher.setPrefix("buckey");
+	vector<DynamicGrammar *> modes;
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	for(int i = 0; i < MODE_COUNT; i++) {
+		istringstream text(modeGrammar(i));
+		DynamicGrammar * g = new DynamicGrammar(text);
+		g->setVariable("extra", "humidity");
+		modes.push_back(g);
+
+		string name = modeWord(i);
+		root.addRule(shared_ptr<Rule>(new Rule(name, false, g->getRule("command")->getRuleExpansion())));
+		for(shared_ptr<Rule> r : g->getRules()) {
+			// The helper rules are the same in every mode, only their variables differ
+			if(r->getRuleName() != "command" && root.getRule(r->getRuleName()) == nullptr) {
+				root.addRule(r);
+			}
+		}
+		modeList->addChild(shared_ptr<Tag>(new Tag(shared_ptr<RuleReference>(new RuleReference(name)), MODE_TAG_PREFIX + name)));
+		matcher.compileMode(name, root, g);
+	}
+	double compileMicros = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - start).count();
+
+	cout << "Grammar Matcher Benchmark" << endl;
+	cout << MODE_COUNT << " modes, " << matcher.getInstructionCount() << " instructions, compiled in " << compileMicros << " us" << (matcher.isComplete() ? "" : " (incomplete!)") << endl;
+
+	vector<string> commands;
+	commands.push_back("buckey " + modeWord(0) + " turn on please");
+	commands.push_back("buckey " + modeWord(MODE_COUNT / 2) + " set level three percent");
+	commands.push_back("buckey " + modeWord(MODE_COUNT - 1) + " tell me the battery and more and more and more");
+	commands.push_back("buckey " + modeWord(MODE_COUNT - 1) + " this does not match");
+
+	bool agree = true;
+	for(const string & c : commands) {
+		chrono::high_resolution_clock::time_point s = chrono::high_resolution_clock::now();
+		MatchResult full;
+		for(int i = 0; i < MATCHES_PER_COMMAND; i++) {
+			full = root.match(c);
+		}
+		double fullNanos = chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - s).count() / MATCHES_PER_COMMAND;
+
+		s = chrono::high_resolution_clock::now();
+		GrammarMatch compiled;
+		for(int i = 0; i < MATCHES_PER_COMMAND; i++) {
+			compiled = matcher.match(c);
+		}
+		double compiledNanos = chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - s).count() / MATCHES_PER_COMMAND;
+
+		// Split the mode tag off the full match the way RootGrammarSnapshot does
+		string fullMode;
+		vector<string> fullTags = full.getMatchingTags();
+		for(vector<string>::iterator t = fullTags.begin(); t != fullTags.end(); t++) {
+			if(t->compare(0, strlen(MODE_TAG_PREFIX), MODE_TAG_PREFIX) == 0) {
+				fullMode = t->substr(strlen(MODE_TAG_PREFIX));
+				fullTags.erase(t);
+				break;
+			}
+		}
+
+		cout << "\"" << c << "\": Grammar::match " << fullNanos << " ns, GrammarMatcher " << compiledNanos << " ns";
+		if(full.matches != compiled.matches || (full.matches && (fullMode != compiled.mode || fullTags != compiled.tags))) {
+			cout << " (results differ! mode " << fullMode << " vs " << compiled.mode << ", " << fullTags.size() << " vs " << compiled.tags.size() << " tags)";
+			agree = false;
+		}
+		cout << endl;
+	}
+
+	// Changing a variable only recompiles the mode it belongs to
+	unsigned long long compiles = matcher.getCompileCount();
+	modes[0]->setVariable("extra", "pressure");
+	unsigned int refreshed = matcher.refresh(root);
+	unsigned long long recompiled = matcher.getCompileCount() - compiles;
+	cout << "Recompiled " << recompiled << " modes after setVariable()" << endl;
+	if(refreshed != 1 || recompiled != 1) {
+		cout << "Only the mode owning the variable should have been recompiled!" << endl;
+		agree = false;
+	}
+
+	for(DynamicGrammar * g : modes) {
+		delete g;
+	}
+	return agree ? 0 : 1;
+}
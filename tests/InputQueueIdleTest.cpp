@@ -0,0 +1,97 @@
+#include "BlockingQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sys/resource.h>
+
+using namespace std;
+
+#define IDLE_SECONDS 2
+///Most CPU time the whole process may use while idle, as a percent of the idle time
+#define MAX_IDLE_CPU_PERCENT 1.0
+#define PRODUCERS 4
+#define ITEMS_PER_PRODUCER 50000
+
+///Returns the user and system CPU time this process has used, in microseconds
+long long cpuMicros() {
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+int main() {
+	bool passed = true;
+	BlockingQueue<string> que;
+	atomic<bool> inConversation(false);
+	atomic<unsigned long> taken(0);
+
+	// Two watchers like Buckey's, one of them only taking input outside of conversations
+	thread watcher([&]() {
+		string s;
+		while(que.pop(s, [&]() { return !inConversation.load(); })) {
+			taken++;
+		}
+	});
+	thread prompt([&]() {
+		string s;
+		while(que.pop(s)) {
+			taken++;
+		}
+	});
+
+	cout << "Idling for " << IDLE_SECONDS << " seconds" << endl;
+	this_thread::sleep_for(chrono::milliseconds(100)); // Let both threads start waiting
+	long long cpuBefore = cpuMicros();
+	unsigned long long wakeupsBefore = que.getWakeups();
+	this_thread::sleep_for(chrono::seconds(IDLE_SECONDS));
+	double cpuPercent = (cpuMicros() - cpuBefore) / (IDLE_SECONDS * 10000.0);
+	unsigned long long idleWakeups = que.getWakeups() - wakeupsBefore;
+	cout << "Idle CPU: " << cpuPercent << "%, wakeups: " << idleWakeups << endl;
+	if(cpuPercent > MAX_IDLE_CPU_PERCENT || idleWakeups != 0) {
+		cout << "FAIL: the queue is not idle while empty" << endl;
+		passed = false;
+	}
+
+	// Every pushed item is taken exactly once, whichever popper takes it
+	inConversation.store(true);
+	vector<thread> producers;
+	for(int p = 0; p < PRODUCERS; p++) {
+		producers.push_back(thread([&que, p]() {
+			for(int i = 0; i < ITEMS_PER_PRODUCER; i++) {
+				que.push(to_string(p) + ":" + to_string(i));
+			}
+		}));
+	}
+	for(thread & t : producers) {
+		t.join();
+	}
+	inConversation.store(false);
+	que.wake();
+	while(!que.empty()) {
+		this_thread::yield();
+	}
+	que.close();
+	watcher.join();
+	prompt.join();
+	cout << "Taken " << taken.load() << " of " << PRODUCERS * ITEMS_PER_PRODUCER << endl;
+	if(taken.load() != PRODUCERS * ITEMS_PER_PRODUCER) {
+		cout << "FAIL: items were lost or taken twice" << endl;
+		passed = false;
+	}
+
+	// A deadline pop on an empty queue gives up on time
+	BlockingQueue<string> empty;
+	string s;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	if(empty.popUntil(s, start + chrono::milliseconds(200)) || chrono::steady_clock::now() - start < chrono::milliseconds(200)) {
+		cout << "FAIL: popUntil did not wait for its deadline" << endl;
+		passed = false;
+	}
+
+	cout << (passed ? "PASSED" : "FAILED") << endl;
+	return passed ? 0 : 1;
+}